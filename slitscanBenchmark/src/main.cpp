@@ -0,0 +1,351 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 james george
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * slitscanBenchmark
+ * 
+ * times addImage, getOutputImage, setDelayMap and setCapacity across
+ * frame sizes, capacities, channel counts, blending and maps. Results
+ * are written to stdout as CSV, one line per operation and setting, so
+ * runs can be compared across releases. Progress goes to stderr.
+ */
+
+#include "ofMain.h"
+#include "ofxSlitScan.h"
+#include <chrono>
+#include <random>
+
+struct BenchmarkSize {
+	string name;
+	int width;
+	int height;
+};
+
+struct BenchmarkResult {
+	double mean;
+	double p50;
+	double p90;
+	double p99;
+};
+
+static const BenchmarkSize sizes[] = {
+	{"vga", 640, 480},
+	{"720p", 1280, 720},
+	{"1080p", 1920, 1080},
+	{"4k", 3840, 2160}
+};
+
+static const char* bundledMaps[] = {"left_to_right", "hard_noise", "random_grid", "video_delay"};
+static const char* syntheticMaps[] = {"gradient", "noise", "constant"};
+
+static double now(){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static BenchmarkResult summarize(vector<double>& seconds){
+	BenchmarkResult result;
+	sort(seconds.begin(), seconds.end());
+	double total = 0;
+	for(size_t i = 0; i < seconds.size(); i++){
+		total += seconds[i];
+	}
+	result.mean = total / seconds.size();
+	result.p50 = seconds[(seconds.size() - 1) * 50 / 100];
+	result.p90 = seconds[(seconds.size() - 1) * 90 / 100];
+	result.p99 = seconds[(seconds.size() - 1) * 99 / 100];
+	return result;
+}
+
+static ofImageType typeForChannels(int channels){
+	return channels == 1 ? OF_IMAGE_GRAYSCALE : channels == 3 ? OF_IMAGE_COLOR : OF_IMAGE_COLOR_ALPHA;
+}
+
+/**
+ * makes one of the synthetic maps, or loads a bundled one scaled to size
+ */
+static bool makeMap(const string& name, const string& mapDirectory, int width, int height, ofImage& map){
+	map.setUseTexture(false);
+	if(name == "gradient" || name == "noise" || name == "constant"){
+		std::mt19937 random(1);
+		map.allocate(width, height, OF_IMAGE_GRAYSCALE);
+		unsigned char* pixels = map.getPixels();
+		for(int y = 0; y < height; y++){
+			for(int x = 0; x < width; x++){
+				unsigned char value = 128;
+				if(name == "gradient"){
+					value = x * 255 / MAX(width - 1, 1);
+				}
+				else if(name == "noise"){
+					value = random() & 0xFF;
+				}
+				pixels[y * width + x] = value;
+			}
+		}
+		return true;
+	}
+	
+	if(!map.loadImage(mapDirectory + "/" + name + ".png")){
+		return false;
+	}
+	if(map.getWidth() != width || map.getHeight() != height){
+		map.resize(width, height);
+	}
+	return true;
+}
+
+static void report(const string& operation, const BenchmarkSize& size, int channels, int capacity, bool blend,
+				   const string& mapName, int threads, int iterations, vector<double>& seconds, double bytesPerCall){
+	BenchmarkResult result = summarize(seconds);
+	double pixels = double(size.width) * size.height;
+	printf("%s,%s,%d,%d,%d,%d,%d,%s,%d,%d,%.4f,%.4f,%.4f,%.4f,%.2f,%.3f\n",
+		   operation.c_str(), size.name.c_str(), size.width, size.height, channels, capacity, blend ? 1 : 0,
+		   mapName.c_str(), threads, iterations,
+		   result.mean * 1000, result.p50 * 1000, result.p90 * 1000, result.p99 * 1000,
+		   pixels / result.p50 / 1e6, bytesPerCall / result.p50 / 1e9);
+	fflush(stdout);
+}
+
+static vector<string> listOption(const string& value){
+	return ofSplitString(value, ",", true, true);
+}
+
+static void usage(){
+	fprintf(stderr,
+		"usage: slitscanBenchmark [options]\n"
+		"  --sizes list        vga,720p,1080p,4k, default vga,720p,1080p\n"
+		"  --capacities list   default 30,120\n"
+		"  --channels list     1,3,4, default 1,3,4\n"
+		"  --maps list         bundled and synthetic maps, default all of\n"
+		"                      left_to_right,hard_noise,random_grid,video_delay,gradient,noise,constant\n"
+		"  --map-dir dir       folder with the bundled maps\n"
+		"  --threads n         render threads, 0 for one per core, default 1\n"
+		"  --iterations n      timed calls per operation, default 50\n"
+		"  --bucketed          render with bucketed rendering on\n");
+}
+
+int main(int argc, char* argv[]){
+	vector<string> sizeNames = listOption("vga,720p,1080p");
+	vector<string> capacities = listOption("30,120");
+	vector<string> channelCounts = listOption("1,3,4");
+	vector<string> mapNames;
+	for(int i = 0; i < 4; i++){
+		mapNames.push_back(bundledMaps[i]);
+	}
+	for(int i = 0; i < 3; i++){
+		mapNames.push_back(syntheticMaps[i]);
+	}
+	string mapDirectory = ofToDataPath("../../../slitscanStandalone/bin/data/maps", true);
+	int threads = 1;
+	int iterations = 50;
+	bool bucketed = false;
+	
+	for(int i = 1; i < argc; i++){
+		string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if(arg == "--sizes" && hasValue){
+			sizeNames = listOption(argv[++i]);
+		}
+		else if(arg == "--capacities" && hasValue){
+			capacities = listOption(argv[++i]);
+		}
+		else if(arg == "--channels" && hasValue){
+			channelCounts = listOption(argv[++i]);
+		}
+		else if(arg == "--maps" && hasValue){
+			mapNames = listOption(argv[++i]);
+		}
+		else if(arg == "--map-dir" && hasValue){
+			mapDirectory = argv[++i];
+		}
+		else if(arg == "--threads" && hasValue){
+			threads = ofToInt(argv[++i]);
+		}
+		else if(arg == "--iterations" && hasValue){
+			iterations = ofToInt(argv[++i]);
+		}
+		else if(arg == "--bucketed"){
+			bucketed = true;
+		}
+		else{
+			usage();
+			return 1;
+		}
+	}
+	
+	iterations = MAX(iterations, 1);
+	
+	printf("operation,size,width,height,channels,capacity,blend,map,threads,iterations,mean_ms,p50_ms,p90_ms,p99_ms,mpix_per_s,gb_per_s\n");
+	
+	std::mt19937 random(7);
+	for(size_t s = 0; s < sizeNames.size(); s++){
+		const BenchmarkSize* size = NULL;
+		for(int i = 0; i < 4; i++){
+			if(sizes[i].name == sizeNames[s]){
+				size = &sizes[i];
+			}
+		}
+		if(size == NULL){
+			ofLog(OF_LOG_ERROR, "slitscanBenchmark -- unknown size %s", sizeNames[s].c_str());
+			continue;
+		}
+		
+		for(size_t c = 0; c < channelCounts.size(); c++){
+			int channels = ofToInt(channelCounts[c]);
+			if(channels != 1 && channels != 3 && channels != 4){
+				ofLog(OF_LOG_ERROR, "slitscanBenchmark -- channels must be 1, 3 or 4");
+				continue;
+			}
+			int frameBytes = size->width * size->height * channels;
+			
+			//a few distinct frames to cycle through
+			vector<vector<unsigned char> > frames(4, vector<unsigned char>(frameBytes));
+			for(size_t f = 0; f < frames.size(); f++){
+				for(int i = 0; i < frameBytes; i++){
+					frames[f][i] = random() & 0xFF;
+				}
+			}
+			
+			for(size_t k = 0; k < capacities.size(); k++){
+				int capacity = MAX(ofToInt(capacities[k]), 1);
+				fprintf(stderr, "slitscanBenchmark -- %s, %d channels, capacity %d\n", size->name.c_str(), channels, capacity);
+				
+				ofxSlitScan warp;
+				warp.setUseTexture(false);
+				warp.setup(size->width, size->height, capacity, typeForChannels(channels));
+				warp.setNumThreads(threads);
+				warp.setBucketedRendering(bucketed);
+				
+				//ingest, the first pass through the ring commits its memory so time the second
+				vector<double> seconds;
+				for(int i = 0; i < capacity; i++){
+					warp.addImage(&frames[i % frames.size()][0]);
+				}
+				for(int i = 0; i < MAX(iterations, capacity); i++){
+					double start = now();
+					warp.addImage(&frames[i % frames.size()][0]);
+					seconds.push_back(now() - start);
+				}
+				report("addImage", *size, channels, capacity, false, "", threads, seconds.size(), seconds, frameBytes);
+				
+				for(size_t m = 0; m < mapNames.size(); m++){
+					ofImage map;
+					if(!makeMap(mapNames[m], mapDirectory, size->width, size->height, map)){
+						ofLog(OF_LOG_ERROR, "slitscanBenchmark -- could not load map %s from %s", mapNames[m].c_str(), mapDirectory.c_str());
+						continue;
+					}
+					
+					seconds.clear();
+					for(int i = 0; i < iterations; i++){
+						double start = now();
+						warp.setDelayMap(map);
+						seconds.push_back(now() - start);
+					}
+					report("setDelayMap", *size, channels, capacity, false, mapNames[m], threads, iterations, seconds,
+						   double(size->width) * size->height * map.getPixelsRef().getNumChannels());
+					
+					for(int blend = 0; blend < 2; blend++){
+						warp.setBlending(blend == 1);
+						
+						//the first render after a map change rebuilds the tables, leave it out
+						warp.addImage(&frames[0][0]);
+						warp.getOutputImage();
+						
+						seconds.clear();
+						for(int i = 0; i < iterations; i++){
+							warp.addImage(&frames[i % frames.size()][0]);
+							double start = now();
+							warp.getOutputImage();
+							seconds.push_back(now() - start);
+						}
+						//every output byte is written and one or two source bytes are read for it
+						report("getOutputImage", *size, channels, capacity, blend == 1, mapNames[m], threads, iterations, seconds,
+							   double(frameBytes) * (blend ? 3 : 2));
+						
+						//a centered crop a sixth of the size each way, 640x360 out of 4k
+						BenchmarkSize crop = {size->name, MAX(size->width / 6, 1), MAX(size->height / 6, 1)};
+						ofPixels region;
+						ofRectangle rect((size->width - crop.width) / 2, (size->height - crop.height) / 2, crop.width, crop.height);
+						seconds.clear();
+						for(int i = 0; i < iterations; i++){
+							warp.addImage(&frames[i % frames.size()][0]);
+							double start = now();
+							warp.renderRegion(rect, region);
+							seconds.push_back(now() - start);
+						}
+						report("renderRegion", crop, channels, capacity, blend == 1, mapNames[m], threads, iterations, seconds,
+							   double(crop.width) * crop.height * channels * (blend ? 3 : 2));
+						
+						//three more outputs off the same history, as for several projectors
+						const char* outputNames[] = {"left", "center", "right"};
+						for(int o = 0; o < 3; o++){
+							warp.addOutput(outputNames[o]);
+							warp.setOutputDelayMap(outputNames[o], map);
+							warp.setOutputTimeDelayAndWidth(outputNames[o], o * capacity / 4, capacity - o * capacity / 4);
+							warp.setOutputBlending(outputNames[o], blend == 1);
+						}
+						warp.getOutputImage();
+						seconds.clear();
+						for(int i = 0; i < iterations; i++){
+							warp.addImage(&frames[i % frames.size()][0]);
+							double start = now();
+							warp.getOutputImage();
+							for(int o = 0; o < 3; o++){
+								warp.getOutputImage(outputNames[o]);
+							}
+							seconds.push_back(now() - start);
+						}
+						report("namedOutputs", *size, channels, capacity, blend == 1, mapNames[m], threads, iterations, seconds,
+							   double(frameBytes) * (blend ? 3 : 2) * 4);
+						for(int o = 0; o < 3; o++){
+							warp.removeOutput(outputNames[o]);
+						}
+					}
+				}
+				
+				//a radial map that moves every frame, worked out as the output renders
+				warp.setBlending(false);
+				seconds.clear();
+				for(int i = 0; i < iterations; i++){
+					warp.addImage(&frames[i % frames.size()][0]);
+					double start = now();
+					ofxSlitScan::ProceduralMap map = {ofxSlitScanCore::MAP_RADIAL, .5f, .5f, 1.f, .5f + .01f * (i % 50), 1.f, 0.f};
+					warp.setDelayMap(map);
+					warp.getOutputImage();
+					seconds.push_back(now() - start);
+				}
+				report("proceduralMap", *size, channels, capacity, false, "radial", threads, iterations, seconds, double(frameBytes) * 2);
+				
+				//within the reservation resizing only turns the ring, no frames move
+				seconds.clear();
+				warp.reserveCapacity(capacity + 1);
+				for(int i = 0; i < iterations; i++){
+					double start = now();
+					warp.setCapacity(i % 2 == 0 ? capacity + 1 : capacity);
+					seconds.push_back(now() - start);
+				}
+				report("setCapacity", *size, channels, capacity, false, "", threads, iterations, seconds, 0);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 james george
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * frameQueue
+ * 
+ * hands frame buffers between the pipeline threads
+ */
+
+#ifndef _FRAME_QUEUE
+#define _FRAME_QUEUE
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+class FrameQueue {
+  public:
+	void push(unsigned char* frame){
+		std::unique_lock<std::mutex> lock(mutex);
+		frames.push_back(frame);
+		condition.notify_one();
+	}
+	
+	/**
+	 * waits for the next frame. NULL marks the end of the stream
+	 */
+	unsigned char* pop(){
+		std::unique_lock<std::mutex> lock(mutex);
+		while(frames.empty()){
+			condition.wait(lock);
+		}
+		unsigned char* frame = frames.front();
+		frames.pop_front();
+		return frame;
+	}
+	
+  protected:
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<unsigned char*> frames;
+};
+
+#endif
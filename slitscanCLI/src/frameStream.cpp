@@ -0,0 +1,215 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 james george
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * frameStream
+ */
+
+#include "frameStream.h"
+
+#define Y4M_SIGNATURE "YUV4MPEG2"
+#define Y4M_FRAME "FRAME"
+
+FrameFormat::FrameFormat()
+:frameBytes(0) {
+}
+
+void FrameFormat::addPlane(int width, int height, ofImageType type){
+	FramePlane plane;
+	plane.width = width;
+	plane.height = height;
+	plane.type = type;
+	plane.offset = frameBytes;
+	plane.bytes = size_t(width) * height * (type == OF_IMAGE_GRAYSCALE ? 1 : type == OF_IMAGE_COLOR ? 3 : 4);
+	planes.push_back(plane);
+	frameBytes += plane.bytes;
+}
+
+bool FrameFormat::setupRaw(int width, int height, ofImageType type){
+	planes.clear();
+	frameBytes = 0;
+	if(width <= 0 || height <= 0){
+		return false;
+	}
+	addPlane(width, height, type);
+	
+	//only gray frames have a Y4M equivalent
+	y4mHeader = "";
+	if(type == OF_IMAGE_GRAYSCALE){
+		y4mHeader = " W" + ofToString(width) + " H" + ofToString(height) + " F30:1 Ip A1:1 Cmono";
+	}
+	return true;
+}
+
+bool FrameFormat::setupY4M(const string& header){
+	planes.clear();
+	frameBytes = 0;
+	
+	int width = 0;
+	int height = 0;
+	string colorspace = "420jpeg";
+	vector<string> tokens = ofSplitString(header, " ", true, true);
+	for(size_t i = 0; i < tokens.size(); i++){
+		char tag = tokens[i][0];
+		string value = tokens[i].substr(1);
+		if(tag == 'W'){
+			width = ofToInt(value);
+		}
+		else if(tag == 'H'){
+			height = ofToInt(value);
+		}
+		else if(tag == 'C'){
+			colorspace = value;
+		}
+	}
+	if(width <= 0 || height <= 0){
+		ofLog(OF_LOG_ERROR, "slitscan -- Y4M header is missing the frame size");
+		return false;
+	}
+	
+	//every plane is warped on its own at its own resolution
+	addPlane(width, height, OF_IMAGE_GRAYSCALE);
+	//420p10 and the like are 16 bit samples, only the 8 bit tags go through
+	if(colorspace == "420" || colorspace == "420jpeg" || colorspace == "420paldv" || colorspace == "420mpeg2"){
+		addPlane((width + 1) / 2, (height + 1) / 2, OF_IMAGE_GRAYSCALE);
+		addPlane((width + 1) / 2, (height + 1) / 2, OF_IMAGE_GRAYSCALE);
+	}
+	else if(colorspace == "422"){
+		addPlane((width + 1) / 2, height, OF_IMAGE_GRAYSCALE);
+		addPlane((width + 1) / 2, height, OF_IMAGE_GRAYSCALE);
+	}
+	else if(colorspace == "444" || colorspace == "444alpha"){
+		addPlane(width, height, OF_IMAGE_GRAYSCALE);
+		addPlane(width, height, OF_IMAGE_GRAYSCALE);
+		if(colorspace == "444alpha"){
+			addPlane(width, height, OF_IMAGE_GRAYSCALE);
+		}
+	}
+	else if(colorspace != "mono"){
+		ofLog(OF_LOG_ERROR, "slitscan -- unsupported Y4M colorspace C%s, only 8 bit 420, 422, 444 and mono are", colorspace.c_str());
+		planes.clear();
+		frameBytes = 0;
+		return false;
+	}
+	
+	y4mHeader = header;
+	return true;
+}
+
+string FrameFormat::getY4MHeader(){
+	return y4mHeader;
+}
+
+FrameReader::FrameReader()
+:file(NULL), y4m(false) {
+}
+
+bool FrameReader::open(FILE* _file, const FrameFormat& rawFormat){
+	file = _file;
+	pending = "";
+	
+	//peek at the start of the stream for the signature
+	char signature[sizeof(Y4M_SIGNATURE) - 1];
+	size_t count = fread(signature, 1, sizeof(signature), file);
+	if(count == sizeof(signature) && memcmp(signature, Y4M_SIGNATURE, sizeof(signature)) == 0){
+		string header;
+		if(!readLine(header)){
+			return false;
+		}
+		y4m = true;
+		return format.setupY4M(header);
+	}
+	
+	y4m = false;
+	pending.assign(signature, count);
+	format = rawFormat;
+	if(format.planes.empty()){
+		ofLog(OF_LOG_ERROR, "slitscan -- input isn't Y4M, raw input needs a frame size");
+		return false;
+	}
+	return true;
+}
+
+bool FrameReader::isY4M(){
+	return y4m;
+}
+
+FrameFormat& FrameReader::getFormat(){
+	return format;
+}
+
+bool FrameReader::readLine(string& line){
+	line = "";
+	int c;
+	while((c = fgetc(file)) != EOF){
+		if(c == '\n'){
+			return true;
+		}
+		line += char(c);
+	}
+	return false;
+}
+
+bool FrameReader::readFrame(unsigned char* pixels){
+	if(y4m){
+		string header;
+		if(!readLine(header)){
+			return false;
+		}
+		if(header.compare(0, sizeof(Y4M_FRAME) - 1, Y4M_FRAME) != 0){
+			ofLog(OF_LOG_ERROR, "slitscan -- expected a Y4M frame header");
+			return false;
+		}
+	}
+	
+	size_t filled = MIN(pending.size(), format.frameBytes);
+	memcpy(pixels, pending.data(), filled);
+	pending.erase(0, filled);
+	return fread(pixels + filled, 1, format.frameBytes - filled, file) == format.frameBytes - filled;
+}
+
+FrameWriter::FrameWriter()
+:file(NULL), y4m(false), frameBytes(0) {
+}
+
+bool FrameWriter::open(FILE* _file, FrameFormat& format, bool _y4m){
+	file = _file;
+	y4m = _y4m;
+	frameBytes = format.frameBytes;
+	if(y4m){
+		string header = format.getY4MHeader();
+		if(header.empty()){
+			ofLog(OF_LOG_ERROR, "slitscan -- color raw frames can't be written as Y4M, use raw output");
+			return false;
+		}
+		fprintf(file, "%s%s\n", Y4M_SIGNATURE, header.c_str());
+	}
+	return true;
+}
+
+bool FrameWriter::writeFrame(const unsigned char* pixels){
+	if(y4m){
+		fputs(Y4M_FRAME "\n", file);
+	}
+	return fwrite(pixels, 1, frameBytes, file) == frameBytes;
+}
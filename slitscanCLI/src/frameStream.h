@@ -0,0 +1,112 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 james george
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * frameStream
+ * 
+ * reads and writes Y4M or raw video frames. Y4M frames are kept as
+ * their separate planes so chroma never has to be resampled
+ */
+
+#ifndef _FRAME_STREAM
+#define _FRAME_STREAM
+
+#include "ofMain.h"
+
+struct FramePlane {
+	int width;
+	int height;
+	ofImageType type;
+	size_t offset;
+	size_t bytes;
+};
+
+class FrameFormat {
+  public:
+	FrameFormat();
+	
+	/**
+	 * a single interleaved plane of gray, rgb or rgba pixels
+	 */
+	bool setupRaw(int width, int height, ofImageType type);
+	
+	/**
+	 * parses the stream header line of a Y4M file,
+	 * without the YUV4MPEG2 signature
+	 */
+	bool setupY4M(const string& header);
+	
+	/**
+	 * the stream header to write for this format, without the
+	 * signature. Empty if the format can't be stored as Y4M
+	 */
+	string getY4MHeader();
+	
+	vector<FramePlane> planes;
+	size_t frameBytes;
+	
+  protected:
+	void addPlane(int width, int height, ofImageType type);
+	string y4mHeader;
+};
+
+class FrameReader {
+  public:
+	FrameReader();
+	
+	/**
+	 * file is read from the start. A Y4M signature switches to Y4M,
+	 * anything else is read as raw frames of rawFormat
+	 */
+	bool open(FILE* file, const FrameFormat& rawFormat);
+	bool isY4M();
+	FrameFormat& getFormat();
+	
+	/**
+	 * fills pixels with the next frame, false at the end of the stream
+	 */
+	bool readFrame(unsigned char* pixels);
+	
+  protected:
+	bool readLine(string& line);
+	FILE* file;
+	bool y4m;
+	FrameFormat format;
+	
+	//bytes read while looking for the signature that belong to the first raw frame
+	string pending;
+};
+
+class FrameWriter {
+  public:
+	FrameWriter();
+	bool open(FILE* file, FrameFormat& format, bool y4m);
+	bool writeFrame(const unsigned char* pixels);
+	
+  protected:
+	FILE* file;
+	bool y4m;
+	size_t frameBytes;
+};
+
+#endif
@@ -0,0 +1,309 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 james george
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * slitscan
+ * 
+ * renders the slit scan effect from the command line without a window.
+ * Frames are read, warped and written on three threads so the render
+ * never waits on the disk or the pipe. The planes of a frame are warped
+ * side by side and split the render threads between them, e.g.
+ *
+ *   ffmpeg -i in.mov -f yuv4mpegpipe - | slitscan -m maps/left_to_right.png -c 240 --blend | ffmpeg -i - out.mov
+ *
+ * A short write, to a full disk or a closed pipe, stops every thread
+ * early and slitscan exits non-zero.
+ */
+
+#include "ofMain.h"
+#include "ofxSlitScan.h"
+#include "frameStream.h"
+#include "frameQueue.h"
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+#ifdef _WIN32
+	#include <io.h>
+	#include <fcntl.h>
+#endif
+
+//frames in flight between each pair of threads
+#define PIPELINE_DEPTH 4
+
+static void usage(){
+	fprintf(stderr,
+		"usage: slitscan -m map [options]\n"
+		"  -m, --map file          delay map image, white is the newest frame\n"
+		"  -i, --input file        Y4M or raw input, default stdin\n"
+		"  -o, --output file       output, default stdout\n"
+		"  -s, --size WxH          frame size of raw input\n"
+		"  -p, --pixels gray|rgb|rgba  pixel format of raw input, default rgb\n"
+		"  -f, --format y4m|raw    output format, default is the input format\n"
+		"  -c, --capacity n        frames of history, default 120\n"
+		"  -d, --delay n           frames of delay, default 0\n"
+		"  -w, --width n           frames the map spans, default the capacity\n"
+		"  -e, --every n           store 1 in every n frames, the history covers n times as long\n"
+		"  -b, --blend             blend between frames\n"
+		"  -t, --threads n         render threads in all, default one per core\n");
+}
+
+//splits threads between the planes by their size, at least one each,
+//with what rounding leaves over going to the first and largest plane
+static vector<int> planeThreads(int threads, const FrameFormat& format){
+	vector<int> shares;
+	int assigned = 0;
+	for(size_t p = 0; p < format.planes.size(); p++){
+		shares.push_back(MAX(1, int(threads * format.planes[p].bytes / format.frameBytes)));
+		assigned += shares.back();
+	}
+	if(assigned < threads){
+		shares[0] += threads - assigned;
+	}
+	return shares;
+}
+
+static bool parseSize(const string& size, int& width, int& height){
+	return sscanf(size.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+int main(int argc, char* argv[]){
+	string mapPath;
+	string inputPath = "-";
+	string outputPath = "-";
+	string outputFormat;
+	int rawWidth = 0;
+	int rawHeight = 0;
+	ofImageType rawType = OF_IMAGE_COLOR;
+	int capacity = 120;
+	int delay = 0;
+	int width = -1;
+	int every = 1;
+	bool blend = false;
+	int threads = 0;
+	
+	for(int i = 1; i < argc; i++){
+		string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if((arg == "-m" || arg == "--map") && hasValue){
+			mapPath = argv[++i];
+		}
+		else if((arg == "-i" || arg == "--input") && hasValue){
+			inputPath = argv[++i];
+		}
+		else if((arg == "-o" || arg == "--output") && hasValue){
+			outputPath = argv[++i];
+		}
+		else if((arg == "-s" || arg == "--size") && hasValue){
+			if(!parseSize(argv[++i], rawWidth, rawHeight)){
+				usage();
+				return 1;
+			}
+		}
+		else if((arg == "-p" || arg == "--pixels") && hasValue){
+			string pixels = argv[++i];
+			if(pixels == "gray"){
+				rawType = OF_IMAGE_GRAYSCALE;
+			}
+			else if(pixels == "rgb"){
+				rawType = OF_IMAGE_COLOR;
+			}
+			else if(pixels == "rgba"){
+				rawType = OF_IMAGE_COLOR_ALPHA;
+			}
+			else{
+				usage();
+				return 1;
+			}
+		}
+		else if((arg == "-f" || arg == "--format") && hasValue){
+			outputFormat = argv[++i];
+		}
+		else if((arg == "-c" || arg == "--capacity") && hasValue){
+			capacity = ofToInt(argv[++i]);
+		}
+		else if((arg == "-d" || arg == "--delay") && hasValue){
+			delay = ofToInt(argv[++i]);
+		}
+		else if((arg == "-w" || arg == "--width") && hasValue){
+			width = ofToInt(argv[++i]);
+		}
+		else if((arg == "-e" || arg == "--every") && hasValue){
+			every = ofToInt(argv[++i]);
+		}
+		else if(arg == "-b" || arg == "--blend"){
+			blend = true;
+		}
+		else if((arg == "-t" || arg == "--threads") && hasValue){
+			threads = ofToInt(argv[++i]);
+		}
+		else{
+			usage();
+			return 1;
+		}
+	}
+	if(mapPath.empty() || capacity <= 0 || every <= 0 || (outputFormat != "" && outputFormat != "y4m" && outputFormat != "raw")){
+		usage();
+		return 1;
+	}
+	
+	//paths are given relative to where we are run from, not to a data folder
+	ofDisableDataPath();
+	ofImage map;
+	map.setUseTexture(false);
+	if(!map.loadImage(mapPath)){
+		ofLog(OF_LOG_ERROR, "slitscan -- could not load map %s", mapPath.c_str());
+		return 1;
+	}
+	
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	FILE* input = inputPath == "-" ? stdin : fopen(inputPath.c_str(), "rb");
+	FILE* output = outputPath == "-" ? stdout : fopen(outputPath.c_str(), "wb");
+	if(input == NULL || output == NULL){
+		ofLog(OF_LOG_ERROR, "slitscan -- could not open %s", input == NULL ? inputPath.c_str() : outputPath.c_str());
+		return 1;
+	}
+	
+	FrameFormat rawFormat;
+	if(rawWidth > 0){
+		rawFormat.setupRaw(rawWidth, rawHeight, rawType);
+	}
+	FrameReader reader;
+	if(!reader.open(input, rawFormat)){
+		return 1;
+	}
+	FrameFormat& format = reader.getFormat();
+	bool y4mOutput = outputFormat == "" ? reader.isY4M() : outputFormat == "y4m";
+	FrameWriter writer;
+	if(!writer.open(output, format, y4mOutput)){
+		return 1;
+	}
+	
+	//planes render in the background side by side when there are threads
+	//enough for one each, otherwise one after another on this thread
+	if(threads <= 0){
+		threads = MAX(1, (int)std::thread::hardware_concurrency());
+	}
+	bool planesInParallel = format.planes.size() > 1 && threads >= (int)format.planes.size();
+	vector<int> threadShares = planesInParallel ? planeThreads(threads, format) : vector<int>(format.planes.size(), threads);
+	
+	//one warp per plane, each with the map scaled to fit
+	vector<ofxSlitScan*> warps;
+	for(size_t p = 0; p < format.planes.size(); p++){
+		FramePlane& plane = format.planes[p];
+		ofImage planeMap = map;
+		if(planeMap.getWidth() != plane.width || planeMap.getHeight() != plane.height){
+			planeMap.resize(plane.width, plane.height);
+		}
+		
+		ofxSlitScan* warp = new ofxSlitScan();
+		warp->setUseTexture(false);
+		warp->setup(plane.width, plane.height, capacity, plane.type);
+		warp->setDelayMap(planeMap);
+		warp->setTimeDelayAndWidth(delay, width < 0 ? capacity - delay : width);
+		warp->setBlending(blend);
+		warp->setNumThreads(threadShares[p]);
+		if(planesInParallel){
+			warp->setAsyncRendering(true, false);
+		}
+		if(every > 1){
+			warp->setAdmission(ofxSlitScanCore::ADMIT_EVERY, every);
+		}
+		warps.push_back(warp);
+	}
+	
+	//each stage hands full buffers on and gets empty ones back
+	vector<unsigned char> buffers(format.frameBytes * PIPELINE_DEPTH * 2);
+	FrameQueue emptyInputs, fullInputs, emptyOutputs, fullOutputs;
+	for(int i = 0; i < PIPELINE_DEPTH; i++){
+		emptyInputs.push(&buffers[format.frameBytes * i]);
+		emptyOutputs.push(&buffers[format.frameBytes * (PIPELINE_DEPTH + i)]);
+	}
+	
+	//set by the writer when the output fails, the other threads stop reading
+	std::atomic<bool> writeFailed(false);
+	
+	std::thread readThread([&](){
+		unsigned char* frame;
+		while(!writeFailed && (frame = emptyInputs.pop()) != NULL && reader.readFrame(frame)){
+			fullInputs.push(frame);
+		}
+		fullInputs.push(NULL);
+	});
+	
+	std::thread writeThread([&](){
+		unsigned char* frame;
+		while((frame = fullOutputs.pop()) != NULL){
+			if(!writeFailed && !writer.writeFrame(frame)){
+				ofLog(OF_LOG_ERROR, "slitscan -- could not write output");
+				writeFailed = true;
+			}
+			emptyOutputs.push(frame);
+		}
+		fflush(output);
+	});
+	
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int frameCount = 0;
+	unsigned char* frame;
+	while(!writeFailed && (frame = fullInputs.pop()) != NULL){
+		for(size_t p = 0; p < warps.size(); p++){
+			//frames that aren't stored aren't copied either
+			warps[p]->addImage(frame + format.planes[p].offset);
+		}
+		emptyInputs.push(frame);
+		
+		unsigned char* rendered = emptyOutputs.pop();
+		for(size_t p = 0; p < warps.size(); p++){
+			FramePlane& plane = format.planes[p];
+			memcpy(rendered + plane.offset, warps[p]->getOutputImage().getPixels(), plane.bytes);
+		}
+		fullOutputs.push(rendered);
+		frameCount++;
+	}
+	
+	//a reader waiting on a buffer gets the end of the stream instead
+	if(writeFailed){
+		emptyInputs.push(NULL);
+	}
+	readThread.join();
+	fullOutputs.push(NULL);
+	writeThread.join();
+	
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	fprintf(stderr, "slitscan -- %d frames in %.2fs, %.1f fps\n", frameCount, seconds, seconds > 0 ? frameCount / seconds : 0);
+	
+	for(size_t p = 0; p < warps.size(); p++){
+		delete warps[p];
+	}
+	if(input != stdin){
+		fclose(input);
+	}
+	if(output != stdout){
+		fclose(output);
+	}
+	return writeFailed ? 1 : 0;
+}
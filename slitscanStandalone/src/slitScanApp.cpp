@@ -69,8 +69,6 @@ void slitScanApp::setup(){
 		sampleMaps.push_back( map );
 	}
 		
-    colorImg.allocate(WIDTH,HEIGHT, OF_IMAGE_COLOR);
-	previewImage.allocate(WIDTH, HEIGHT, OF_IMAGE_COLOR);
 	warpImage.allocate(WIDTH, HEIGHT, OF_IMAGE_COLOR);
 	customMap.allocate(WIDTH, HEIGHT, OF_IMAGE_GRAYSCALE);
 	
@@ -90,6 +88,7 @@ void slitScanApp::setup(){
 	initLiveVideo();
 	
 	warp.setBlending(true);
+	warp.setNumThreads(0);
 	warp.setDelayMap(*(sampleMaps[0]));
 	
 	//load buttons
@@ -138,9 +137,6 @@ void slitScanApp::initMovie(){
 		vidPlayer.setSpeed(1);
 		movieImg.allocate(vidPlayer.width, vidPlayer.height, OF_IMAGE_COLOR);
 		vidPlayer.play();	
-		if(vidPlayer.width != WIDTH || vidPlayer.height != HEIGHT){
-			movieImage.allocate(vidPlayer.width, vidPlayer.height, OF_IMAGE_COLOR);
-		}
 	}
 }
 
@@ -157,24 +153,15 @@ void slitScanApp::update(){
 
 	if (bNewFrame && !isPaused){
 		if(useLiveVideo){
-            colorImg.setFromPixels(vidGrabber.getPixels(), WIDTH,HEIGHT, OF_IMAGE_COLOR);
+			//copy the grabber frame straight into the slit scan history
+			memcpy(warp.beginFrame(), vidGrabber.getPixels(), WIDTH*HEIGHT*3);
+			warp.commitFrame();
 	    }
 		else{
-			unsigned char* inPixels;
-			if(vidPlayer.width == WIDTH || vidPlayer.height == HEIGHT){
-				inPixels = vidPlayer.getPixels();
-			}
-			else {
-				movieImage.setFromPixels(vidPlayer.getPixels(), vidPlayer.width,vidPlayer.height, OF_IMAGE_COLOR);
-				ofImage resized = movieImage;
-				resized.resize(WIDTH, HEIGHT);
-				inPixels = resized.getPixels();
-			}
-			colorImg.setFromPixels(inPixels, WIDTH, HEIGHT, OF_IMAGE_COLOR);
+			//each frame, call addImage to ofxSlitScan.
+			//movies of another size are scaled on the way in
+			warp.addImage(vidPlayer.getPixelsRef());
 		}
-		
-		//each frame, call addImage to ofxSlitScan.
-		warp.addImage(colorImg);
 	}
 }
 
@@ -371,10 +358,9 @@ void slitScanApp::draw(){
 		ofSetHexColor(0xffffff);		
 		int frameStep = warp.getCapacity() / framesToShow;
 		int fameIndex = 0;
-		unsigned char* pixels = previewImage.getPixels();
 		for(int i = 0; i < framesToShow; i ++){
-			warp.pixelsForFrame(warp.getCapacity() - (frameStep*i) - 1, pixels);
-			previewImage.setFromPixels(pixels, WIDTH, HEIGHT, OF_IMAGE_COLOR);
+			const unsigned char* pixels = warp.getThumbnail(warp.getCapacity() - (frameStep*i) - 1);
+			previewImage.setFromPixels(pixels, warp.getThumbnailWidth(), warp.getThumbnailHeight(), OF_IMAGE_COLOR);
 			previewImage.draw(widthPerFrame*i, FRAME_PADDING, widthPerFrame, heightPerFrame);
 		}
 		
@@ -440,6 +426,8 @@ void slitScanApp::changeCapacity()
 		warp.setCapacity(capacity);
 	}
 	else{
+		//the capacity slider only hands frames around within the reservation
+		warp.reserveCapacity(MAX_CAPACITY);
 		warp.setup(WIDTH, HEIGHT, capacity);
 		warp.setDelayMap(*sampleMaps[currentSampleMapIndex]);
 		
@@ -451,6 +439,7 @@ void slitScanApp::changeCapacity()
 	heightPerFrame = 49;
 	widthPerFrame  = 1.0 * WIDTH / HEIGHT * heightPerFrame;
 	filmStripWidth = widthPerFrame*framesToShow;
+	warp.setThumbnails(widthPerFrame, heightPerFrame);
 }
 
 void slitScanApp::keyPressed(int key){
@@ -579,11 +568,8 @@ bool slitScanApp::loadCustomMapIndex()
 		return false;
 	}
 	
+	//maps of any size are resampled to the output
 	customMap.loadImage(mapfile);
-	if(customMap.width != WIDTH || customMap.height != HEIGHT){
-		customMap.resize(WIDTH, HEIGHT);
-	}
-	
 	warp.setDelayMap(customMap);	
 	return true;
 }
@@ -51,11 +51,9 @@ class slitScanApp : public ofBaseApp {
 	ofVideoGrabber	vidGrabber;
 	ofVideoPlayer	vidPlayer;
 	
-	ofImage	colorImg;
 	ofImage movieImg;
 	ofImage	warpImage;
 	ofImage previewImage;
-	ofImage movieImage;
 	
 	ofxSlitScan warp;
 	int capacity;
@@ -45,298 +45,448 @@
 
 #include "ofxSlitScan.h"
 
-#define BYTES_PER_PIXEL 3
+static int channelsForType(ofImageType type){
+	switch (type) {
+		case OF_IMAGE_GRAYSCALE: return 1;
+		case OF_IMAGE_COLOR: return 3;
+		case OF_IMAGE_COLOR_ALPHA: return 4;
+		default: return 0;
+	}
+}
 
-//converts from an index (0, capacity) to the appropriate fraem in the rolling buffer
-static inline int frame_index(int framepointer, int index, int capacity){ 
-	framepointer += index;
-    if(framepointer < capacity) {
-        return framepointer;
-    }
-    return framepointer - capacity;
+//images of another type are converted from the matching raw format
+static ofxSlitScan::PixelFormat formatForChannels(int channels){
+	return channels == 1 ? ofxSlitScanConvert::FORMAT_GRAY :
+		(channels == 3 ? ofxSlitScanConvert::FORMAT_RGB : ofxSlitScanConvert::FORMAT_RGBA);
+}
+
+//core messages end up in the openFrameworks log
+static void logToOF(ofxSlitScanCore::LogLevel level, const string& message){
+	ofLog(level == ofxSlitScanCore::LOG_ERROR ? OF_LOG_ERROR : OF_LOG_WARNING, message);
 }
 
 ofxSlitScan::ofxSlitScan()
-:buffersAllocated(false) {
-}
-
-void ofxSlitScan::setup(int w, int h, int _capacity) {
-    switch (BYTES_PER_PIXEL) {
-		case 1:{
-			type = OF_IMAGE_GRAYSCALE;
-		}break;
-		case 3:{
-			type = OF_IMAGE_COLOR;
-		}break;
-		case 4:{
-			type = OF_IMAGE_COLOR_ALPHA;
-		}break;
-		default:{
-			ofLog(OF_LOG_ERROR, "ofxSlitScan Error -- Invalid image type");
-			return;
-		}break;
+:outputVersion(0), delayMapIsDirty(false), type(OF_IMAGE_COLOR), useTexture(true) {
+	ofxSlitScanCore::setLogFunction(logToOF);
+}
+
+ofxSlitScan::~ofxSlitScan(){
+}
+
+void ofxSlitScan::setup(int w, int h, int _capacity, ofImageType _type) {
+	if(channelsForType(_type) == 0){
+		ofLog(OF_LOG_ERROR, "ofxSlitScan Error -- Invalid image type");
+		return;
 	}
-    
-	//clean up if reallocating
-	if(buffersAllocated){
-		free(delayMapPixels);
-		for(int i = 0; i < capacity; i++){
-			free(buffer[i]);
-		}
-		free(buffer);
-		buffersAllocated = false;
+	core.setup(w, h, _capacity, channelsForType(_type));
+	if(!core.isSetup()){
+		return;
 	}
+	type = _type;
+	namedImages.clear();
+	namedVersions.clear();
 	
-	width = w;
-	height = h;
-	capacity = _capacity;
-	framepointer = 0;
-	blend = false;
-	timeDelay = 0;
-	timeWidth = capacity;
-	bytesPerFrame = width*height*BYTES_PER_PIXEL;
-	delayMapPixels = (float*)calloc(w*h, sizeof(float));
-	buffer = (unsigned char**)calloc(capacity, sizeof(unsigned char*));
-	for(int i = 0; i < capacity; i++){
-		buffer[i] = (unsigned char*)calloc(bytesPerFrame, sizeof(unsigned char));
-	}
+	outputImage.setUseTexture(useTexture);
+	delayMapImage.setUseTexture(useTexture);
 	outputImage.allocate(w, h, type);
 	delayMapImage.allocate(w, h, OF_IMAGE_GRAYSCALE);
-	buffersAllocated = true;
-	outputIsDirty = true;
+	core.setOutputBuffer(outputImage.getPixels());
 	delayMapIsDirty = true;
 }
 
 bool ofxSlitScan::isSetup(){
-	return buffersAllocated;
+	return core.isSetup();
 }
 
-void ofxSlitScan::setCapacity(int _capacity){
-	if(_capacity <= 0){
-		_capacity = 1;
-	}
-	
-	if(_capacity == capacity){
+void ofxSlitScan::setAsyncRendering(bool async, bool allowLatency){
+	core.setAsyncRendering(async, allowLatency);
+	outputVersion = 0;
+}
+
+bool ofxSlitScan::isAsyncRendering(){
+	return core.isAsyncRendering();
+}
+
+void ofxSlitScan::setUseTexture(bool _useTexture){
+	useTexture = _useTexture;
+}
+
+void ofxSlitScan::setDelayMap(ofBaseHasPixels& map){
+    setDelayMap(map.getPixelsRef());
+}
+
+void ofxSlitScan::setDelayMap(ofPixels& map){
+	if(channelsForType(map.getImageType()) == 0){
+		ofLog(OF_LOG_ERROR, "ofxSlitScan -- unsupported image map type");
 		return;
 	}
-	
-	//the new capacity is bigger
-	if (capacity < _capacity) {
-		buffer = (unsigned char**)realloc(buffer, _capacity*sizeof(unsigned char*));
-		for(int i = capacity; i < _capacity; i++){
-			buffer[i] = (unsigned char*)calloc(bytesPerFrame, sizeof(unsigned char));
-		}
-	}
-	//the new capacity is smaller
-	else {
-		for( int i = _capacity; i < capacity; i++){
-			free(buffer[i]);
-		}
-		buffer = (unsigned char**)realloc(buffer, _capacity*sizeof(unsigned char*));
-		framepointer %= _capacity;
-	}
-	capacity = _capacity;
-	outputIsDirty = true;
+	core.setDelayMap(map.getPixels(), map.getWidth(), map.getHeight(), channelsForType(map.getImageType()));
+	delayMapIsDirty = true;
 }
 
-void ofxSlitScan::setDelayMap(unsigned char* pix, ofImageType type){
-	switch (type) {
-		case OF_IMAGE_COLOR:{
-			for(int i = 0; i < width*height; i++){
-				//RGB 0 - 255 ==> YUV 0.0 - 1.0
-				delayMapPixels[i] = (0.299*pix[i*3] + 0.587*pix[i*3+1] + 0.114*pix[i*3+2]) / 255.0; 
-			}				
-		}break;
-			
-		case OF_IMAGE_COLOR_ALPHA:{
-			for(int i = 0; i < width*height; i++){
-				//RGBA 0 - 255 ==> YUV 0.0 - 1.0
-				delayMapPixels[i] = (0.299*pix[i*4] + 0.587*pix[i*4+1] + 0.114*pix[i*4+2]) / 255.0;
-			}				
-		}break;
-			
-		case OF_IMAGE_GRAYSCALE:{
-			for(int i = 0; i < width*height; i++){
-				delayMapPixels[i] = pix[i] / 255.0;
-			}	
-		}break;
-			
-		default:{
-			ofLog(OF_LOG_ERROR, "ofxSlitScan -- unsupported image map type");
-		}break;
+void ofxSlitScan::setDelayMap(unsigned char* map, ofImageType mapType){
+	if(channelsForType(mapType) == 0){
+		ofLog(OF_LOG_ERROR, "ofxSlitScan -- unsupported image map type");
+		return;
 	}
-    
+	core.setDelayMap(map, channelsForType(mapType));
 	delayMapIsDirty = true;
-	outputIsDirty = true; 
 }
 
-void ofxSlitScan::setDelayMap(float* mappix){
-	//assumed monochrome float image
-	for(int i = 0; i < width*height; i++){
-		delayMapPixels[i] = mappix[i];
-	}
+void ofxSlitScan::setDelayMap(float* map){
+	core.setDelayMap(map);
 	delayMapIsDirty = true;
-	outputIsDirty = true; 
 }
 
-void ofxSlitScan::setDelayMap(ofBaseHasPixels& map){
-    setDelayMap(map.getPixelsRef());
+void ofxSlitScan::setDelayMap(const ProceduralMap& map){
+	core.setDelayMap(map);
+	delayMapIsDirty = true;
 }
 
-void ofxSlitScan::setDelayMap(ofPixels& map){
-	if(map.getWidth() != width || map.getHeight() != height){
-		ofLog(OF_LOG_ERROR,"ofxSlitScan Error -- Map dimensions do not match image dimensions. given %fx%f, need %dx%d\n", map.getWidth(), map.getHeight(), width, height);
+bool ofxSlitScan::isDelayMapProcedural(){
+	return core.isDelayMapProcedural();
+}
+
+void ofxSlitScan::setOutputSize(int w, int h, Resampling resampling){
+	core.setOutputSize(w, h, resampling);
+	if(!core.isSetup()){
 		return;
 	}
-	setDelayMap(map.getPixels(), map.getImageType());
+	if(outputImage.getWidth() != getOutputWidth() || outputImage.getHeight() != getOutputHeight()){
+		outputImage.allocate(getOutputWidth(), getOutputHeight(), type);
+		delayMapImage.allocate(getOutputWidth(), getOutputHeight(), OF_IMAGE_GRAYSCALE);
+	}
+	core.setOutputBuffer(outputImage.getPixels());
+	outputVersion = 0;
+	delayMapIsDirty = true;
 }
 
-void ofxSlitScan::setBlending(bool _blend){
-	blend = _blend;
-	outputIsDirty = true;
+int ofxSlitScan::getOutputWidth(){
+	return core.getOutputWidth();
 }
 
-void ofxSlitScan::toggleBlending(){
-	blend = !blend;
-	outputIsDirty = true;
+int ofxSlitScan::getOutputHeight(){
+	return core.getOutputHeight();
 }
 
-void ofxSlitScan::addImage(unsigned char* image){
-	
-	//write the image into the buffer
-	memcpy(buffer[framepointer], image, bytesPerFrame*sizeof(unsigned char));
-	
-	//increment the framepointer
-	framepointer = ( (framepointer + 1) % capacity );	
-	
-	outputIsDirty = true;	
+void ofxSlitScan::setTransferCurve(const vector<float>& curve){
+	core.setTransferCurve(curve);
 }
+
 void ofxSlitScan::addImage(ofBaseHasPixels& image){
     addImage(image.getPixelsRef());
 }
 
 void ofxSlitScan::addImage(ofPixels& image){
-	if(image.getImageType() != type){
-		ofLog(OF_LOG_ERROR, "ofxSlitScan -- adding image of the wrong type");
+	if(image.getImageType() != type || image.getWidth() != getWidth() || image.getHeight() != getHeight()){
+		int channels = channelsForType(image.getImageType());
+		if(channels == 0){
+			ofLog(OF_LOG_ERROR, "ofxSlitScan -- adding image of the wrong type");
+			return;
+		}
+		addImage(image.getPixels(), image.getWidth(), image.getHeight(), formatForChannels(channels));
 		return;
 	}
 	addImage( image.getPixels() );
 }
 
-ofImage& ofxSlitScan::getOutputImage(){
-	if(outputIsDirty){
-		//calculate the new distorted image
-		unsigned char* writebuffer = outputImage.getPixels();
-		unsigned char* outbuffer = writebuffer;
-		
-		int x, y, offset, lower_offset, upper_offset, pixelIndex;
-		float precise, alpha, invalpha;	
-		int mapMin = capacity - timeDelay - timeWidth;// (time_delay + time_width);
-		int mapMax = capacity - 1 - timeDelay;// - time_delay;
-        int mapRange = mapMax - mapMin;
-        int n = width * height;
-        pixelIndex = 0;
-        
-		if(blend){
-			for(int i = 0; i < n; i++) {
-                //find pixel point in local reference
-                precise = delayMapPixels[i] * mapRange + mapMin;
-                //cast it to an integer
-                offset = int(precise);
-                
-                //calculate alpha
-                alpha = precise - offset;
-                invalpha = 1 - alpha;
-                
-                //convert to framepointer reference point
-                lower_offset = frame_index(framepointer, offset, capacity);
-                upper_offset = frame_index(framepointer, offset+1, capacity);
-                
-                //get buffers
-                unsigned char *a = buffer[lower_offset] + pixelIndex;
-                unsigned char *b = buffer[upper_offset] + pixelIndex;
-                
-                //interpolate and set values
-                for(int c = 0; c < BYTES_PER_PIXEL; c++) {
-                    *outbuffer++ = (a[c]*invalpha)+(b[c]*alpha);
-                }
-                pixelIndex += BYTES_PER_PIXEL;
-            }
-		}
-		else{
-            pixelIndex = 0;
-			for(int i = 0; i < n; i++) {
-                int index = delayMapPixels[i] * mapRange + mapMin;
-                index = frame_index(framepointer, index, capacity);
-                // faster than memcpy because the compiler can optimize it
-                for(int c = 0; c < BYTES_PER_PIXEL; c++) {
-                    *outbuffer++ = buffer[index][pixelIndex + c];
-                }
-                pixelIndex += BYTES_PER_PIXEL;
-			}
+void ofxSlitScan::addImage(unsigned char* image){
+	core.addFrame(image);
+}
+
+void ofxSlitScan::addImage(const unsigned char* image, int w, int h, PixelFormat format, size_t stride){
+	core.addFrame(image, w, h, format, stride);
+}
+
+unsigned char* ofxSlitScan::beginFrame(){
+	return core.beginFrame();
+}
+
+void ofxSlitScan::commitFrame(){
+	core.commitFrame();
+}
+
+void ofxSlitScan::setIngestQueue(int depth, IngestPolicy policy){
+	core.setIngestQueue(depth, policy);
+}
+
+void ofxSlitScan::closeIngestQueue(){
+	core.closeIngestQueue();
+}
+
+bool ofxSlitScan::queueImage(ofPixels& image){
+	if(image.getImageType() != type || image.getWidth() != getWidth() || image.getHeight() != getHeight()){
+		int channels = channelsForType(image.getImageType());
+		if(channels == 0){
+			ofLog(OF_LOG_ERROR, "ofxSlitScan -- queueing image of the wrong type");
+			return false;
 		}
-		outputImage.setFromPixels(writebuffer, width, height, type);
-		outputIsDirty = false;
+		return queueImage(image.getPixels(), image.getWidth(), image.getHeight(), formatForChannels(channels));
 	}
+	return core.queueFrame(image.getPixels());
+}
 
+bool ofxSlitScan::queueImage(const unsigned char* image, int w, int h, PixelFormat format, size_t stride){
+	return core.queueFrame(image, w, h, format, stride);
+}
+
+unsigned char* ofxSlitScan::beginQueuedFrame(){
+	return core.beginQueuedFrame();
+}
+
+bool ofxSlitScan::commitQueuedFrame(){
+	return core.commitQueuedFrame();
+}
+
+int ofxSlitScan::takeQueuedImages(){
+	return core.takeQueuedFrames();
+}
+
+void ofxSlitScan::adoptImage(unsigned char* image, ReleaseCallback release){
+	core.adoptFrame(image, release);
+}
+
+void ofxSlitScan::setAdmission(Admission admission, double amount){
+	core.setAdmission(admission, amount);
+}
+
+ofxSlitScan::Admission ofxSlitScan::getAdmission(){
+	return core.getAdmission();
+}
+
+bool ofxSlitScan::admitsNextFrame(){
+	return core.admitsNextFrame();
+}
+
+int ofxSlitScan::getAdmittedEvery(){
+	return core.getAdmittedEvery();
+}
+
+ofImage& ofxSlitScan::getOutputImage(){
+	//queued images go in first so the dirty check sees them
+	core.takeQueuedFrames();
+	if(core.isAsyncRendering()){
+		unsigned long long version;
+		const unsigned char* pixels = core.getOutput(&version);
+		if(version != outputVersion){
+			outputImage.setFromPixels(pixels, getOutputWidth(), getOutputHeight(), type);
+			outputVersion = version;
+		}
+		return outputImage;
+	}
+	
+	bool rendering = core.isOutputDirty();
+	core.getOutput();
+	if(rendering){
+		unsigned char* writebuffer = outputImage.getPixels();
+		outputImage.setFromPixels(writebuffer, getOutputWidth(), getOutputHeight(), type);
+	}
 	return outputImage;
 }
 
+bool ofxSlitScan::renderRegion(const ofRectangle& region, ofPixels& pixels){
+	int w = region.width;
+	int h = region.height;
+	if(pixels.getWidth() != w || pixels.getHeight() != h || pixels.getImageType() != type){
+		pixels.allocate(w, h, type);
+	}
+	return core.renderRegion(region.x, region.y, w, h, pixels.getPixels());
+}
+
+bool ofxSlitScan::renderRegion(int x, int y, int w, int h, unsigned char* pixels, size_t stride){
+	return core.renderRegion(x, y, w, h, pixels, stride);
+}
+
+bool ofxSlitScan::addOutput(const string& name){
+	return core.addOutput(name);
+}
+
+void ofxSlitScan::removeOutput(const string& name){
+	core.removeOutput(name);
+	namedImages.erase(name);
+	namedVersions.erase(name);
+}
+
+bool ofxSlitScan::hasOutput(const string& name){
+	return core.hasOutput(name);
+}
+
+void ofxSlitScan::setOutputDelayMap(const string& name, ofBaseHasPixels& map){
+	setOutputDelayMap(name, map.getPixelsRef());
+}
+
+void ofxSlitScan::setOutputDelayMap(const string& name, ofPixels& map){
+	if(channelsForType(map.getImageType()) == 0){
+		ofLog(OF_LOG_ERROR, "ofxSlitScan -- unsupported image map type");
+		return;
+	}
+	core.setOutputDelayMap(name, map.getPixels(), map.getWidth(), map.getHeight(), channelsForType(map.getImageType()));
+}
+
+void ofxSlitScan::setOutputTimeDelayAndWidth(const string& name, int timeDelay, int timeWidth){
+	core.setOutputTimeDelayAndWidth(name, timeDelay, timeWidth);
+}
+
+void ofxSlitScan::setOutputBlending(const string& name, bool blend){
+	core.setOutputBlending(name, blend);
+}
+
+ofImage& ofxSlitScan::getOutputImage(const string& name){
+	ofImage& image = namedImages[name];
+	unsigned long long version;
+	const unsigned char* pixels = core.getOutput(name, &version);
+	if(pixels != NULL && (!image.isAllocated() || version != namedVersions[name])){
+		image.setUseTexture(useTexture);
+		image.setFromPixels(pixels, getWidth(), getHeight(), type);
+		namedVersions[name] = version;
+	}
+	return image;
+}
+
 ofImage& ofxSlitScan::getDelayMap(){
 	if(delayMapIsDirty){
 		unsigned char* pix = delayMapImage.getPixels();
-		for(int i = 0; i < width*height; i++){
-			pix[i] = char(delayMapPixels[i]*255);
-		}
-		delayMapImage.setFromPixels(pix, width, height, OF_IMAGE_GRAYSCALE);
+		core.copyDelayMap(pix);
+		delayMapImage.setFromPixels(pix, getOutputWidth(), getOutputHeight(), OF_IMAGE_GRAYSCALE);
 		delayMapIsDirty = false;
 	}
 	return delayMapImage;
 }
 
-int ofxSlitScan::getWidth(){
-	return width;
+void ofxSlitScan::pixelsForFrame(int num, unsigned char* outbuf){
+	core.pixelsForFrame(num, outbuf);
 }
 
-int ofxSlitScan::getHeight(){
-	return height;
+ofxSlitScan::FrameView ofxSlitScan::getFrameView(int num){
+	return core.getFrameView(num);
 }
 
-void ofxSlitScan::pixelsForFrame(int num, unsigned char* outbuf){
-	memcpy(outbuf, buffer[frame_index(framepointer, num, capacity)], bytesPerFrame*sizeof(unsigned char));
+bool ofxSlitScan::isCurrent(const FrameView& view){
+	return core.isCurrent(view);
 }
 
-void ofxSlitScan::setTimeDelayAndWidth(int _timeDelay, int _timeWidth){
-	timeDelay = ofClamp(_timeDelay, 0, capacity-1);
-	timeWidth = ofClamp(_timeWidth, 1, capacity);
-	if(timeDelay + timeWidth > capacity){
-		ofLog(OF_LOG_ERROR, "ofxSlitScan -- Invalid time delay and width specified, adds to %d with a capacity of %d", (timeDelay+timeWidth), capacity);
-		timeDelay = 0;
-		timeWidth = capacity;
-	}
-	outputIsDirty = true;	
+bool ofxSlitScan::pinFrame(const FrameView& view){
+	return core.pinFrame(view);
 }
 
-void ofxSlitScan::setTimeDelay(int _timeDelay){
-	timeDelay = ofClamp(_timeDelay, 0, capacity - timeWidth - 1);
-	outputIsDirty = true;
+void ofxSlitScan::unpinFrame(const FrameView& view){
+	core.unpinFrame(view);
 }
 
-void ofxSlitScan::setTimeWidth(int _timeWidth){
-	timeWidth = ofClamp(_timeWidth, 1, capacity - timeDelay);
-	outputIsDirty = true;
+void ofxSlitScan::setThumbnails(int w, int h){
+	core.setThumbnails(w, h);
 }
 
-int ofxSlitScan::getCapacity(){
-	return capacity;
+int ofxSlitScan::getThumbnailWidth(){
+	return core.getThumbnailWidth();
+}
+
+int ofxSlitScan::getThumbnailHeight(){
+	return core.getThumbnailHeight();
+}
+
+const unsigned char* ofxSlitScan::getThumbnail(int num){
+	return core.getThumbnail(num);
+}
+
+void ofxSlitScan::setCapacity(int capacity){
+	core.setCapacity(capacity);
+}
+
+void ofxSlitScan::reserveCapacity(int frames){
+	core.reserveCapacity(frames);
+}
+
+int ofxSlitScan::getReservedCapacity(){
+	return core.getReservedCapacity();
+}
+
+void ofxSlitScan::setTimeDelayAndWidth(int timeDelay, int timeWidth){
+	core.setTimeDelayAndWidth(timeDelay, timeWidth);
+}
+
+void ofxSlitScan::setTimeDelay(int timeDelay){
+	core.setTimeDelay(timeDelay);
+}
+
+void ofxSlitScan::setTimeWidth(int timeWidth){
+	core.setTimeWidth(timeWidth);
+}
+
+void ofxSlitScan::setBlending(bool blend){
+	core.setBlending(blend);
+}
+
+void ofxSlitScan::toggleBlending(){
+	core.toggleBlending();
+}
+
+void ofxSlitScan::setNumThreads(int numThreads){
+	core.setNumThreads(numThreads);
+}
+
+int ofxSlitScan::getNumThreads(){
+	return core.getNumThreads();
+}
+
+void ofxSlitScan::setBucketedRendering(bool bucketed){
+	core.setBucketedRendering(bucketed);
+}
+
+bool ofxSlitScan::isBucketedRendering(){
+	return core.isBucketedRendering();
+}
+
+void ofxSlitScan::setSparseRetention(bool sparse){
+	core.setSparseRetention(sparse);
+}
+
+bool ofxSlitScan::isSparseRetention(){
+	return core.isSparseRetention();
+}
+
+void ofxSlitScan::setColdCompression(int age){
+	core.setColdCompression(age);
+}
+
+int ofxSlitScan::getColdCompression(){
+	return core.getColdCompression();
+}
+
+void ofxSlitScan::setColdCacheSize(int blocks){
+	core.setColdCacheSize(blocks);
+}
+
+bool ofxSlitScan::setHistoryDirectory(const string& directory){
+	return core.setHistoryDirectory(directory);
+}
+
+string ofxSlitScan::getHistoryDirectory(){
+	return core.getHistoryDirectory();
+}
+
+size_t ofxSlitScan::getHistoryBytes(){
+	return core.getHistoryBytes();
 }
 
 int ofxSlitScan::getTimeDelay(){
-	return timeDelay;
+	return core.getTimeDelay();
 }
 
 int ofxSlitScan::getTimeWidth(){
-	return timeWidth;
+	return core.getTimeWidth();
+}
+
+int ofxSlitScan::getWidth(){
+	return core.getWidth();
+}
+
+int ofxSlitScan::getHeight(){
+	return core.getHeight();
+}
+
+int ofxSlitScan::getCapacity(){
+	return core.getCapacity();
 }
 
 ofImageType ofxSlitScan::getType(){
@@ -344,6 +494,17 @@ ofImageType ofxSlitScan::getType(){
 }
 
 bool ofxSlitScan::isBlending(){	
-	return blend;
+	return core.isBlending();
 }
 
+const ofxSlitScan::Stats& ofxSlitScan::getStats(){
+	return core.getStats();
+}
+
+void ofxSlitScan::resetStats(){
+	core.resetStats();
+}
+
+ofxSlitScanCore& ofxSlitScan::getCore(){
+	return core;
+}
@@ -41,17 +41,22 @@
  * after calling setup, use any image to set the delay map 
  * then with every incoming frame call addImage();
  * Calling getOutputImage will return a reference to the warped / delayed video frame
+ *
+ * This class adapts ofxSlitScanCore, which does the actual work, to
+ * ofImage and ofPixels
  */
 
 #ifndef _OFX_SLITSCAN
 #define _OFX_SLITSCAN
 
 #import "ofMain.h"
+#include "ofxSlitScanCore.h"
 
 class ofxSlitScan
 {
   public:
 	ofxSlitScan();
+	~ofxSlitScan();
 	
 	/**
 	 * Width / Height of input stream
@@ -60,14 +65,15 @@ class ofxSlitScan
 	 * type is  OF_IMAGE_GRAYSCALE, OF_IMAGE_COLOR, or OF_IMAGE_COLOR_ALPHA
 	 * default type is OF_IMAGE_COLOR
 	 */
-	void setup(int w, int h, int capacity);
+	void setup(int w, int h, int capacity, ofImageType type = OF_IMAGE_COLOR);
 
 	bool isSetup();
 
 	/**
 	 * set the map used to distort the frame buffer.
-	 * the Map is a grayscale image the same dimensions
-	 * as the input stream. 
+	 * the Map is a grayscale image, resampled to the output
+	 * if it isn't the same size. The raw pointer versions take
+	 * a map the size of the output.
 	 * White pixels map to the newest frames and black the oldest,
 	 * gray in between.
 	 */
@@ -76,6 +82,35 @@ class ofxSlitScan
 	void setDelayMap(unsigned char* map, ofImageType type);
 	void setDelayMap(float* map);
 	
+	/**
+	 * a map worked out from the position as the output renders, with
+	 * nothing stored per pixel, so it can change every frame for free.
+	 * See ofxSlitScanCore::setDelayMap(const ProceduralMap&)
+	 */
+	typedef ofxSlitScanCore::ProceduralMap ProceduralMap;
+	void setDelayMap(const ProceduralMap& map);
+	bool isDelayMapProcedural();
+	
+	/**
+	 * renders the output at w x h instead of the size of the input
+	 * stream, resampling the history as it goes. The output and delay
+	 * map images are reallocated to the new size.
+	 * See ofxSlitScanCore::setOutputSize
+	 */
+	typedef ofxSlitScanCore::Resampling Resampling;
+	void setOutputSize(int w, int h, Resampling resampling = ofxSlitScanCore::RESAMPLE_BILINEAR);
+	int getOutputWidth();
+	int getOutputHeight();
+	
+	/**
+	 * optional transfer curve applied to the delay map values.
+	 * the curve is sampled evenly over 0.0 - 1.0 and maps map
+	 * values to new values in 0.0 - 1.0. Changing the curve only
+	 * rebuilds the level lookup table, not the per pixel map.
+	 * pass an empty curve to turn it off.
+	 */
+	void setTransferCurve(const vector<float>& curve);
+	
 	/**
 	 * add an image to the input system
 	 * call this in succession, once per frame, when reading
@@ -84,6 +119,60 @@ class ofxSlitScan
 	void addImage(ofBaseHasPixels& image);
     void addImage(ofPixels& image);
 	void addImage(unsigned char* image);
+	
+	/**
+	 * images that aren't the size or type of the stream are scaled and
+	 * converted on the way in, in one pass. The raw version takes RGB,
+	 * BGR, RGBA, BGRA, YUYV or NV12. See ofxSlitScanCore::addFrame
+	 */
+	typedef ofxSlitScanCore::PixelFormat PixelFormat;
+	void addImage(const unsigned char* image, int w, int h, PixelFormat format, size_t stride = 0);
+	
+	/**
+	 * zero copy ingest. beginFrame returns the slot in the history the
+	 * next frame goes into. Write, decode or capture width*height*channels
+	 * bytes straight into it, then call commitFrame to add it.
+	 * Don't get the output image in between the two calls.
+	 */
+	unsigned char* beginFrame();
+	void commitFrame();
+	
+	/**
+	 * adds a caller owned frame to the history without copying it.
+	 * The frame has to stay valid until release is called with it,
+	 * which happens once it falls out of the history
+	 */
+	typedef ofxSlitScanCore::ReleaseCallback ReleaseCallback;
+	void adoptImage(unsigned char* image, ReleaseCallback release);
+	
+	/**
+	 * stores only some of the images added, every nth, up to a frame
+	 * rate, or as many as the render keeps up with, so the same capacity
+	 * covers a longer time. admitsNextFrame tells if the next image will
+	 * be stored. See ofxSlitScanCore::setAdmission
+	 */
+	typedef ofxSlitScanCore::Admission Admission;
+	void setAdmission(Admission admission, double amount = 0);
+	Admission getAdmission();
+	bool admitsNextFrame();
+	int getAdmittedEvery();
+	
+	/**
+	 * lets a capture thread queue images without a lock while this
+	 * thread draws. getOutputImage, or takeQueuedImages, moves them into
+	 * the history here, so capture can leave the main thread.
+	 * The queue functions are the only ones to call from the capture
+	 * thread and return false for dropped images.
+	 * See ofxSlitScanCore::setIngestQueue
+	 */
+	typedef ofxSlitScanCore::IngestPolicy IngestPolicy;
+	void setIngestQueue(int depth, IngestPolicy policy = ofxSlitScanIngestQueue::DROP_OLDEST);
+	void closeIngestQueue();
+	bool queueImage(ofPixels& image);
+	bool queueImage(const unsigned char* image, int w, int h, PixelFormat format, size_t stride = 0);
+	unsigned char* beginQueuedFrame();
+	bool commitQueuedFrame();
+	int takeQueuedImages();
 
 	/**
 	 * returns the results of the
@@ -91,6 +180,46 @@ class ofxSlitScan
 	 */
 	ofImage& getOutputImage();
 	
+	/**
+	 * renders only part of the output into pixels, which are allocated
+	 * to the size of region. Nothing is rendered if nothing changed since
+	 * the same region last went into the same pixels.
+	 * See ofxSlitScanCore::renderRegion
+	 */
+	bool renderRegion(const ofRectangle& region, ofPixels& pixels);
+	bool renderRegion(int x, int y, int w, int h, unsigned char* pixels, size_t stride = 0);
+	
+	/**
+	 * more outputs from the same history, each with its own delay map,
+	 * delay, width and blending, so several maps don't each need a copy
+	 * of the history. Named outputs are the size of the input stream.
+	 * See ofxSlitScanCore::addOutput
+	 */
+	bool addOutput(const string& name);
+	void removeOutput(const string& name);
+	bool hasOutput(const string& name);
+	void setOutputDelayMap(const string& name, ofBaseHasPixels& map);
+	void setOutputDelayMap(const string& name, ofPixels& map);
+	void setOutputTimeDelayAndWidth(const string& name, int timeDelay, int timeWidth);
+	void setOutputBlending(const string& name, bool blend);
+	ofImage& getOutputImage(const string& name);
+	
+	/**
+	 * turn on to render in the background as soon as a frame is added,
+	 * so getOutputImage doesn't hold up drawing. See
+	 * ofxSlitScanCore::setAsyncRendering. The finished output is copied
+	 * into the output image the first time it is asked for
+	 */
+	void setAsyncRendering(bool async, bool allowLatency = true);
+	bool isAsyncRendering();
+	
+	/**
+	 * turn off to keep the output and delay map images out of
+	 * textures, needed when running without a window.
+	 * Call before setup
+	 */
+	void setUseTexture(bool useTexture);
+	
 	/**
 	 * gives you the output image back as an ofImage
 	 */
@@ -103,10 +232,34 @@ class ofxSlitScan
 	void pixelsForFrame(int num, unsigned char* outbuf);
 	
 	/**
-	 * reset the maxmum delay. Call this sparingly
-	 * as it incurs memory allocation
+	 * the pixels of frame "num" without copying them, with a frame id
+	 * to tell when they go stale. Pin a view to keep its pixels while
+	 * images are added. See ofxSlitScanCore::getFrameView
+	 */
+	typedef ofxSlitScanCore::FrameView FrameView;
+	FrameView getFrameView(int num);
+	bool isCurrent(const FrameView& view);
+	bool pinFrame(const FrameView& view);
+	void unpinFrame(const FrameView& view);
+	
+	/**
+	 * keeps a small w x h copy of every frame as it is added, see
+	 * ofxSlitScanCore::setThumbnails. getThumbnail returns the pixels
+	 * of the thumbnail for frame "num", of the same type as the frames
+	 */
+	void setThumbnails(int w, int h);
+	int getThumbnailWidth();
+	int getThumbnailHeight();
+	const unsigned char* getThumbnail(int num);
+	
+	/**
+	 * reset the maxmum delay, keeping the frames that still fit in
+	 * order. Doesn't allocate up to the reserved capacity, see
+	 * ofxSlitScanCore::reserveCapacity
 	 */
 	void setCapacity(int capacity); 
+	void reserveCapacity(int frames);
+	int getReservedCapacity();
 	
 	/**
 	 * Allows clamping of the delay amount and width of the delay within the capacity
@@ -119,10 +272,70 @@ class ofxSlitScan
 	
 	/**
 	 * turn on to smooth inter-frame differences
+	 * blending uses 8 bit fixed point weights, see ofxSlitScanKernels.h
 	 */
 	void setBlending(bool blend);
 	void toggleBlending();
 	
+	/**
+	 * number of threads used to render the output, including
+	 * the calling thread. The output is split into bands of rows
+	 * that the threads pull from as they finish.
+	 * default is 1, pass 0 to use one thread per core
+	 */
+	void setNumThreads(int numThreads);
+	int getNumThreads();
+	
+	/**
+	 * turn on to render the output one source frame at a time instead
+	 * of row by row. Output pixels are sorted by the frame they read
+	 * from whenever the map, delay or width change, so each frame is
+	 * streamed through once per render. Helps a lot with noisy maps
+	 * that jump between many frames from pixel to pixel.
+	 */
+	void setBucketedRendering(bool bucketed);
+	bool isBucketedRendering();
+	
+	/**
+	 * turn on to keep only the history the current map will still read.
+	 * Each pixel keeps a delay line exactly as long as the deepest frame
+	 * its map value reaches, so maps that stay near the present, or a
+	 * delay and width that only use part of the capacity, need far less
+	 * memory than capacity full frames.
+	 * Changing the map, delay, width or capacity while this is on
+	 * rebuilds the retained history. Pixels that now reach further back
+	 * than was kept come back black until the history fills in again.
+	 */
+	void setSparseRetention(bool sparse);
+	bool isSparseRetention();
+	
+	/**
+	 * compresses frames losslessly once they are older than age frames,
+	 * 0 turns it off. Compression runs on a background thread and the
+	 * render expands old frames a block of rows at a time, keeping the
+	 * most recently used blocks in a small cache.
+	 * Only applies to the full history, not sparse retention.
+	 */
+	void setColdCompression(int age);
+	int getColdCompression();
+	void setColdCacheSize(int blocks);
+	
+	/**
+	 * keeps the full history in a scratch file in directory instead of
+	 * memory, so it can hold far more frames than fit in RAM. Put it on a
+	 * fast local drive. Only the frames inside the delay and width window
+	 * are read ahead, new frames are flushed as they come in.
+	 * Pass an empty string to go back to memory. Returns false and keeps
+	 * the current history if the file can't be made
+	 */
+	bool setHistoryDirectory(const string& directory);
+	string getHistoryDirectory();
+	
+	/**
+	 * bytes of memory the frame history currently takes up
+	 */
+	size_t getHistoryBytes();
+	
 	int getTimeDelay();
 	int getTimeWidth();
 	int getWidth();
@@ -131,23 +344,35 @@ class ofxSlitScan
 	ofImageType getType();
 	bool isBlending();
 	
+	/**
+	 * timing and sampling counters, see ofxSlitScanCore::Stats
+	 */
+	typedef ofxSlitScanCore::Stats Stats;
+	const Stats& getStats();
+	void resetStats();
+	
+	/**
+	 * the engine underneath, for anything that works on raw buffers
+	 */
+	ofxSlitScanCore& getCore();
+	
   protected:
-	unsigned char ** buffer;
-	float * delayMapPixels;
-	bool blend;
-
-	bool outputIsDirty;
+	ofxSlitScanCore core;
+	
+	//the core renders straight into the pixels of outputImage,
+	//unless it renders asynchronously into buffers of its own
 	ofImage outputImage;
+	unsigned long long outputVersion;
+	
+	//named outputs are copied into their images when they change
+	map<string, ofImage> namedImages;
+	map<string, unsigned long long> namedVersions;
 	
 	bool delayMapIsDirty;
 	ofImage delayMapImage;
 	
-	int timeWidth, timeDelay, framepointer, capacity;
-	int width, height;
 	ofImageType type;
-	
-	int bytesPerFrame;
-	bool buffersAllocated;
+	bool useTexture;
 };
 
-#endif
\ No newline at end of file
+#endif
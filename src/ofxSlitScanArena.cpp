@@ -0,0 +1,296 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanArena.cpp
+ */
+
+#include "ofxSlitScanArena.h"
+#include <algorithm>
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <stdlib.h>
+	#include <vector>
+#endif
+
+static size_t pageSize(){
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+#ifdef _WIN32
+	#define NO_FILE NULL
+#else
+	#define NO_FILE -1
+#endif
+
+//the range of whole pages covering offset to offset + length
+static void pageRange(size_t offset, size_t length, size_t& start, size_t& end){
+	size_t page = pageSize();
+	start = offset / page * page;
+	end = (offset + length + page - 1) / page * page;
+}
+
+ofxSlitScanArena::ofxSlitScanArena()
+:data(NULL), size(0), file(NO_FILE)
+#ifdef _WIN32
+, mapping(NULL)
+#endif
+{
+}
+
+ofxSlitScanArena::~ofxSlitScanArena(){
+	release();
+}
+
+bool ofxSlitScanArena::allocate(size_t _size){
+	release();
+	if(_size == 0){
+		return false;
+	}
+	
+#ifdef _WIN32
+	void* block = VirtualAlloc(NULL, _size, MEM_RESERVE, PAGE_NOACCESS);
+	if(block == NULL){
+		return false;
+	}
+#else
+	//anonymous mappings are zero filled and only backed by memory once touched
+	int flags = MAP_PRIVATE | MAP_ANON;
+	#ifdef MAP_NORESERVE
+	flags |= MAP_NORESERVE;
+	#endif
+	void* block = mmap(NULL, _size, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if(block == MAP_FAILED){
+		return false;
+	}
+#endif
+	
+	data = (unsigned char*)block;
+	size = _size;
+	return true;
+}
+
+bool ofxSlitScanArena::allocateFile(size_t _size, const std::string& directory){
+	release();
+	if(_size == 0){
+		return false;
+	}
+	
+#ifdef _WIN32
+	char path[MAX_PATH];
+	if(GetTempFileNameA(directory.c_str(), "oss", 0, path) == 0){
+		return false;
+	}
+	file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+					   FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+	if(file == INVALID_HANDLE_VALUE){
+		file = NULL;
+		DeleteFileA(path);
+		return false;
+	}
+	mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, DWORD((unsigned long long)_size >> 32), DWORD(_size & 0xFFFFFFFF), NULL);
+	void* block = mapping == NULL ? NULL : MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, _size);
+	if(block == NULL){
+		data = NULL;
+		release();
+		return false;
+	}
+#else
+	std::string pattern = directory + "/ofxSlitScanXXXXXX";
+	std::vector<char> path(pattern.begin(), pattern.end());
+	path.push_back('\0');
+	file = mkstemp(&path[0]);
+	if(file == -1){
+		return false;
+	}
+	//nothing else needs to find the file, it lives on through the descriptor
+	unlink(&path[0]);
+	
+	//the file stays sparse until frames are written to it
+	void* block = ftruncate(file, _size) == 0 ? mmap(NULL, _size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) : MAP_FAILED;
+	if(block == MAP_FAILED){
+		release();
+		return false;
+	}
+	//the render jumps between frames, so leave readahead to the prefetch hints
+	madvise(block, _size, MADV_RANDOM);
+#endif
+	
+	data = (unsigned char*)block;
+	size = _size;
+	return true;
+}
+
+void ofxSlitScanArena::release(){
+	if(data != NULL){
+#ifdef _WIN32
+		if(isFileBacked()){
+			UnmapViewOfFile(data);
+		}
+		else{
+			VirtualFree(data, 0, MEM_RELEASE);
+		}
+#else
+		munmap(data, size);
+#endif
+	}
+#ifdef _WIN32
+	if(mapping != NULL){
+		CloseHandle(mapping);
+		mapping = NULL;
+	}
+	if(file != NULL){
+		CloseHandle(file);
+	}
+#else
+	if(file != -1){
+		close(file);
+	}
+#endif
+	file = NO_FILE;
+	data = NULL;
+	size = 0;
+}
+
+void ofxSlitScanArena::swap(ofxSlitScanArena& other){
+	std::swap(data, other.data);
+	std::swap(size, other.size);
+	std::swap(file, other.file);
+#ifdef _WIN32
+	std::swap(mapping, other.mapping);
+#endif
+}
+
+void ofxSlitScanArena::commit(size_t offset, size_t length){
+#ifdef _WIN32
+	//file views are committed as a whole
+	if(data != NULL && length > 0 && !isFileBacked()){
+		VirtualAlloc(data + offset, length, MEM_COMMIT, PAGE_READWRITE);
+	}
+#else
+	//pages are committed by the first write
+	(void)offset;
+	(void)length;
+#endif
+}
+
+void ofxSlitScanArena::decommit(size_t offset, size_t length){
+	if(data == NULL){
+		return;
+	}
+	
+	//only whole pages inside the range can be handed back
+	size_t page = pageSize();
+	size_t start = (offset + page - 1) / page * page;
+	size_t end = (offset + length) / page * page;
+	if(end <= start){
+		return;
+	}
+	
+#ifdef _WIN32
+	if(!isFileBacked()){
+		VirtualFree(data + start, end - start, MEM_DECOMMIT);
+	}
+#else
+	madvise(data + start, end - start, MADV_DONTNEED);
+#endif
+}
+
+void ofxSlitScanArena::prefetch(size_t offset, size_t length){
+	if(!isFileBacked() || length == 0){
+		return;
+	}
+	size_t start, end;
+	pageRange(offset, length, start, end);
+#ifdef _WIN32
+	//PrefetchVirtualMemory needs Windows 8, the first touch pages it in otherwise
+	(void)start;
+	(void)end;
+#else
+	madvise(data + start, end - start, MADV_WILLNEED);
+#endif
+}
+
+void ofxSlitScanArena::writeBack(size_t offset, size_t length){
+	if(!isFileBacked() || length == 0){
+		return;
+	}
+	size_t start, end;
+	pageRange(offset, length, start, end);
+#ifdef _WIN32
+	FlushViewOfFile(data + start, end - start);
+#elif defined(__linux__)
+	//start the write now instead of letting dirty frames pile up
+	sync_file_range(file, start, end - start, SYNC_FILE_RANGE_WRITE);
+#else
+	msync(data + start, end - start, MS_ASYNC);
+#endif
+}
+
+void ofxSlitScanArena::evict(size_t offset, size_t length){
+	if(!isFileBacked() || length == 0){
+		return;
+	}
+	size_t start, end;
+	pageRange(offset, length, start, end);
+#ifdef _WIN32
+	//unlocking pages that aren't locked takes them out of the working set
+	VirtualUnlock(data + start, end - start);
+#else
+	//shared pages come back from the file on the next read
+	madvise(data + start, end - start, MADV_DONTNEED);
+	#ifdef POSIX_FADV_DONTNEED
+	posix_fadvise(file, start, end - start, POSIX_FADV_DONTNEED);
+	#endif
+#endif
+}
+
+unsigned char* ofxSlitScanArena::getData(){
+	return data;
+}
+
+size_t ofxSlitScanArena::getSize(){
+	return size;
+}
+
+bool ofxSlitScanArena::isAllocated(){
+	return data != NULL;
+}
+
+bool ofxSlitScanArena::isFileBacked(){
+	return file != NO_FILE;
+}
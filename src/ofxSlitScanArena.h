@@ -0,0 +1,110 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanArena.h
+ *
+ * One contiguous, page aligned block of memory for the frame history.
+ * The block is only reserved up front, pages are committed the first
+ * time a range is written so a large capacity costs nothing until
+ * frames actually arrive.
+ *
+ * The block can also be a mapping of a scratch file, which lets the
+ * history grow past physical memory. The file is removed as soon as
+ * it is mapped and goes away with the arena.
+ */
+
+#ifndef _OFX_SLITSCAN_ARENA
+#define _OFX_SLITSCAN_ARENA
+
+#include <cstddef>
+#include <string>
+
+class ofxSlitScanArena
+{
+  public:
+	ofxSlitScanArena();
+	~ofxSlitScanArena();
+	
+	/**
+	 * reserves size bytes, releasing any previous block.
+	 * returns false if the address space could not be reserved
+	 */
+	bool allocate(size_t size);
+	
+	/**
+	 * maps size bytes of a new scratch file in directory.
+	 * returns false if the file could not be created or mapped
+	 */
+	bool allocateFile(size_t size, const std::string& directory);
+	void release();
+	
+	/**
+	 * exchanges blocks with another arena
+	 */
+	void swap(ofxSlitScanArena& other);
+	
+	/**
+	 * makes a range writable. Call before the first write to it
+	 */
+	void commit(size_t offset, size_t length);
+	
+	/**
+	 * hands the pages of a range back to the system, their
+	 * contents are lost
+	 */
+	void decommit(size_t offset, size_t length);
+	
+	/**
+	 * hints for file backed arenas, ignored otherwise.
+	 * prefetch starts reading a range in ahead of use, writeBack starts
+	 * flushing a range that was just written and evict drops a range from
+	 * memory without losing it
+	 */
+	void prefetch(size_t offset, size_t length);
+	void writeBack(size_t offset, size_t length);
+	void evict(size_t offset, size_t length);
+	
+	unsigned char* getData();
+	size_t getSize();
+	bool isAllocated();
+	bool isFileBacked();
+	
+  protected:
+	unsigned char* data;
+	size_t size;
+	
+	//handles of the scratch file, if there is one
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#else
+	int file;
+#endif
+	
+  private:
+	ofxSlitScanArena(const ofxSlitScanArena&);
+	ofxSlitScanArena& operator=(const ofxSlitScanArena&);
+};
+
+#endif
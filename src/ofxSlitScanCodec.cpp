@@ -0,0 +1,176 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanCodec.cpp
+ */
+
+#include "ofxSlitScanCodec.h"
+#include <cstring>
+
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+#define HASH_BITS 12
+
+static inline unsigned int read32(const unsigned char* p){
+	unsigned int value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static inline int hash32(unsigned int value){
+	return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+//lengths of 15 and up continue in extra bytes of 255 until a smaller byte
+static inline void writeLength(std::vector<unsigned char>& dst, int length){
+	while(length >= 255){
+		dst.push_back(255);
+		length -= 255;
+	}
+	dst.push_back(length);
+}
+
+static void writeSequence(std::vector<unsigned char>& dst, const unsigned char* literals, int literalCount, int offset, int matchLength){
+	int matchCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+	unsigned char token = ((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15);
+	dst.push_back(token);
+	if(literalCount >= 15){
+		writeLength(dst, literalCount - 15);
+	}
+	dst.insert(dst.end(), literals, literals + literalCount);
+	if(matchLength > 0){
+		dst.push_back(offset & 0xFF);
+		dst.push_back(offset >> 8);
+		if(matchCode >= 15){
+			writeLength(dst, matchCode - 15);
+		}
+	}
+}
+
+void ofxSlitScanCodec::compress(const unsigned char* src, int size, std::vector<unsigned char>& dst){
+	dst.clear();
+	dst.reserve(size / 2 + 16);
+	
+	int table[1 << HASH_BITS];
+	for(int i = 0; i < (1 << HASH_BITS); i++){
+		table[i] = -1;
+	}
+	
+	int anchor = 0;
+	int position = 0;
+	while(position + MIN_MATCH <= size){
+		unsigned int sequence = read32(src + position);
+		int h = hash32(sequence);
+		int candidate = table[h];
+		table[h] = position;
+		
+		if(candidate < 0 || position - candidate > MAX_OFFSET || read32(src + candidate) != sequence){
+			position++;
+			continue;
+		}
+		
+		int matchLength = MIN_MATCH;
+		while(position + matchLength < size && src[candidate + matchLength] == src[position + matchLength]){
+			matchLength++;
+		}
+		
+		writeSequence(dst, src + anchor, position - anchor, position - candidate, matchLength);
+		position += matchLength;
+		anchor = position;
+	}
+	
+	//whatever is left goes out as literals
+	writeSequence(dst, src + anchor, size - anchor, 0, 0);
+}
+
+bool ofxSlitScanCodec::decompress(const unsigned char* src, int srcSize, unsigned char* dst, int size){
+	const unsigned char* in = src;
+	const unsigned char* inEnd = src + srcSize;
+	int out = 0;
+	bool finished = false;
+	
+	while(in < inEnd){
+		unsigned char token = *in++;
+		
+		int literalCount = token >> 4;
+		if(literalCount == 15){
+			unsigned char extra;
+			do{
+				if(in >= inEnd){
+					return false;
+				}
+				extra = *in++;
+				literalCount += extra;
+			}while(extra == 255);
+		}
+		if(literalCount > inEnd - in || literalCount > size - out){
+			return false;
+		}
+		//an empty block may come with no dst at all
+		if(literalCount > 0){
+			memcpy(dst + out, in, literalCount);
+		}
+		in += literalCount;
+		out += literalCount;
+		
+		//the last sequence has no match
+		if(in >= inEnd){
+			finished = true;
+			break;
+		}
+		
+		if(inEnd - in < 2){
+			return false;
+		}
+		int offset = in[0] | (in[1] << 8);
+		in += 2;
+		
+		int matchLength = (token & 0x0F);
+		if(matchLength == 15){
+			unsigned char extra;
+			do{
+				if(in >= inEnd){
+					return false;
+				}
+				extra = *in++;
+				matchLength += extra;
+			}while(extra == 255);
+		}
+		matchLength += MIN_MATCH;
+		
+		if(offset == 0 || offset > out || matchLength > size - out){
+			return false;
+		}
+		
+		//matches can overlap what they are copying, go byte by byte
+		const unsigned char* match = dst + out - offset;
+		for(int i = 0; i < matchLength; i++){
+			dst[out + i] = match[i];
+		}
+		out += matchLength;
+	}
+	
+	//a block cut off after a whole match is missing its last sequence
+	return finished && out == size;
+}
@@ -0,0 +1,53 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanCodec.h
+ *
+ * A small lossless LZ77 block codec in the spirit of LZ4, used to
+ * keep old frames of the history compressed. Each block is a run of
+ * sequences: a token byte holding the literal count and match length,
+ * the literals, then a two byte offset back to the match.
+ */
+
+#ifndef _OFX_SLITSCAN_CODEC
+#define _OFX_SLITSCAN_CODEC
+
+#include <vector>
+
+class ofxSlitScanCodec
+{
+  public:
+	/**
+	 * compresses size bytes of src, replacing the contents of dst
+	 */
+	static void compress(const unsigned char* src, int size, std::vector<unsigned char>& dst);
+	
+	/**
+	 * expands a compressed block into dst, which has room for size bytes.
+	 * returns false if the block is corrupt or doesn't expand to size bytes
+	 */
+	static bool decompress(const unsigned char* src, int srcSize, unsigned char* dst, int size);
+};
+
+#endif
@@ -0,0 +1,296 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanColdStore.cpp
+ */
+
+#include "ofxSlitScanColdStore.h"
+#include "ofxSlitScanCodec.h"
+#include "ofxSlitScanRing.h"
+#include <cstring>
+
+ofxSlitScanColdStore::ofxSlitScanColdStore()
+:frameBytes(0), blockBytes(0), blocksPerFrame(0), compressedBytes(0), activeSlot(-1), stopping(false), cacheSize(64) {
+}
+
+ofxSlitScanColdStore::~ofxSlitScanColdStore(){
+	stopWorker();
+}
+
+void ofxSlitScanColdStore::setup(int slots, int _frameBytes, int _blockBytes){
+	clear();
+	frameBytes = _frameBytes;
+	blockBytes = _blockBytes;
+	blocksPerFrame = (frameBytes + blockBytes - 1) / blockBytes;
+	frames.assign(slots, std::vector<std::vector<unsigned char> >());
+	generations.assign(slots, 0);
+}
+
+void ofxSlitScanColdStore::clear(){
+	//nothing may still be reading frames that are about to go away
+	stopWorker();
+	jobs.clear();
+	finished.clear();
+	frames.clear();
+	generations.clear();
+	compressedBytes = 0;
+	
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cache.clear();
+}
+
+bool ofxSlitScanColdStore::isSetup(){
+	return !frames.empty();
+}
+
+void ofxSlitScanColdStore::setCacheSize(int blocks){
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cacheSize = blocks < 0 ? 0 : blocks;
+	while((int)cache.size() > cacheSize){
+		cache.pop_back();
+	}
+}
+
+void ofxSlitScanColdStore::compress(int slot, const unsigned char* pixels){
+	if(!worker.joinable()){
+		startWorker();
+	}
+	
+	Job job;
+	job.slot = slot;
+	job.pixels = pixels;
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		jobs.push_back(job);
+	}
+	jobCondition.notify_all();
+}
+
+void ofxSlitScanColdStore::cancel(int slot){
+	{
+		std::unique_lock<std::mutex> lock(jobMutex);
+		for(std::deque<Job>::iterator it = jobs.begin(); it != jobs.end();){
+			if(it->slot == slot){
+				it = jobs.erase(it);
+			}
+			else{
+				++it;
+			}
+		}
+		
+		//the worker is reading the slot right now, let it finish
+		jobCondition.wait(lock, [&]{ return activeSlot != slot; });
+		
+		for(size_t i = 0; i < finished.size();){
+			if(finished[i].first == slot){
+				finished.erase(finished.begin() + i);
+			}
+			else{
+				i++;
+			}
+		}
+	}
+	
+	if(slot < (int)frames.size() && !frames[slot].empty()){
+		for(size_t block = 0; block < frames[slot].size(); block++){
+			compressedBytes -= frames[slot][block].size();
+		}
+		frames[slot].clear();
+		generations[slot]++;
+	}
+}
+
+void ofxSlitScanColdStore::resizeSlots(int first, int change){
+	int slots = frames.size();
+	for(int i = 0; i < -change; i++){
+		cancel((first + i) % slots);
+	}
+	
+	//jobs and finished frames are known by slot too, and so is the one
+	//the worker is on, which it finishes under its new slot
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		for(size_t i = 0; i < jobs.size(); i++){
+			jobs[i].slot = ofxSlitScanRing::resizedSlot(jobs[i].slot, slots, first, change);
+		}
+		for(size_t i = 0; i < finished.size(); i++){
+			finished[i].first = ofxSlitScanRing::resizedSlot(finished[i].first, slots, first, change);
+		}
+		if(activeSlot >= 0){
+			activeSlot = ofxSlitScanRing::resizedSlot(activeSlot, slots, first, change);
+		}
+	}
+	ofxSlitScanRing::resize(frames, first, change, std::vector<std::vector<unsigned char> >());
+	ofxSlitScanRing::resize(generations, first, change, 0u);
+	
+	//cached blocks are known by slot and generation, which just moved around
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cache.clear();
+}
+
+void ofxSlitScanColdStore::cancelPending(){
+	std::unique_lock<std::mutex> lock(jobMutex);
+	jobs.clear();
+	jobCondition.wait(lock, [&]{ return activeSlot < 0; });
+	finished.clear();
+}
+
+void ofxSlitScanColdStore::collect(std::vector<int>& slots){
+	slots.clear();
+	std::lock_guard<std::mutex> lock(jobMutex);
+	for(size_t i = 0; i < finished.size(); i++){
+		int slot = finished[i].first;
+		frames[slot].swap(finished[i].second);
+		for(size_t block = 0; block < frames[slot].size(); block++){
+			compressedBytes += frames[slot][block].size();
+		}
+		generations[slot]++;
+		slots.push_back(slot);
+	}
+	finished.clear();
+}
+
+bool ofxSlitScanColdStore::isCold(int slot){
+	return !frames[slot].empty();
+}
+
+bool ofxSlitScanColdStore::isPending(int slot){
+	std::lock_guard<std::mutex> lock(jobMutex);
+	if(activeSlot == slot){
+		return true;
+	}
+	for(size_t i = 0; i < jobs.size(); i++){
+		if(jobs[i].slot == slot){
+			return true;
+		}
+	}
+	for(size_t i = 0; i < finished.size(); i++){
+		if(finished[i].first == slot){
+			return true;
+		}
+	}
+	return false;
+}
+
+ofxSlitScanColdStore::Block ofxSlitScanColdStore::getBlock(int slot, int block){
+	unsigned int generation = generations[slot];
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		for(std::list<CacheEntry>::iterator it = cache.begin(); it != cache.end(); ++it){
+			if(it->slot == slot && it->block == block && it->generation == generation){
+				//most recently used stays at the front
+				cache.splice(cache.begin(), cache, it);
+				return it->pixels;
+			}
+		}
+	}
+	
+	int size = block == blocksPerFrame - 1 ? frameBytes - block * blockBytes : blockBytes;
+	std::shared_ptr<std::vector<unsigned char> > pixels(new std::vector<unsigned char>(size));
+	decompressBlock(slot, block, &(*pixels)[0]);
+	
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	if(cacheSize > 0){
+		CacheEntry entry;
+		entry.slot = slot;
+		entry.generation = generation;
+		entry.block = block;
+		entry.pixels = pixels;
+		cache.push_front(entry);
+		while((int)cache.size() > cacheSize){
+			cache.pop_back();
+		}
+	}
+	return pixels;
+}
+
+int ofxSlitScanColdStore::getBlockBytes(){
+	return blockBytes;
+}
+
+void ofxSlitScanColdStore::copyFrame(int slot, unsigned char* pixels){
+	for(int block = 0; block < blocksPerFrame; block++){
+		decompressBlock(slot, block, pixels + block * blockBytes);
+	}
+}
+
+size_t ofxSlitScanColdStore::getCompressedBytes(){
+	return compressedBytes;
+}
+
+bool ofxSlitScanColdStore::decompressBlock(int slot, int block, unsigned char* pixels){
+	int size = block == blocksPerFrame - 1 ? frameBytes - block * blockBytes : blockBytes;
+	const std::vector<unsigned char>& compressed = frames[slot][block];
+	if(!ofxSlitScanCodec::decompress(&compressed[0], compressed.size(), pixels, size)){
+		memset(pixels, 0, size);
+		return false;
+	}
+	return true;
+}
+
+void ofxSlitScanColdStore::startWorker(){
+	stopping = false;
+	worker = std::thread(&ofxSlitScanColdStore::workerLoop, this);
+}
+
+void ofxSlitScanColdStore::stopWorker(){
+	if(!worker.joinable()){
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = true;
+	}
+	jobCondition.notify_all();
+	worker.join();
+	stopping = false;
+}
+
+void ofxSlitScanColdStore::workerLoop(){
+	std::unique_lock<std::mutex> lock(jobMutex);
+	while(true){
+		jobCondition.wait(lock, [this]{ return stopping || !jobs.empty(); });
+		if(stopping){
+			return;
+		}
+		
+		Job job = jobs.front();
+		jobs.pop_front();
+		activeSlot = job.slot;
+		lock.unlock();
+		
+		std::vector<std::vector<unsigned char> > blocks(blocksPerFrame);
+		for(int block = 0; block < blocksPerFrame; block++){
+			int size = block == blocksPerFrame - 1 ? frameBytes - block * blockBytes : blockBytes;
+			ofxSlitScanCodec::compress(job.pixels + block * blockBytes, size, blocks[block]);
+		}
+		
+		//the slot may have moved while the frame was compressed
+		lock.lock();
+		finished.push_back(std::make_pair(activeSlot, std::vector<std::vector<unsigned char> >()));
+		finished.back().second.swap(blocks);
+		activeSlot = -1;
+		jobCondition.notify_all();
+	}
+}
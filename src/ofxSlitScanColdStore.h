@@ -0,0 +1,156 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanColdStore.h
+ *
+ * Compressed copies of old history frames. Frames are handed over
+ * by slot and compressed on a background thread in blocks of rows.
+ * The owner collects finished frames on its own thread, after which
+ * blocks are decompressed on demand through a small shared cache.
+ */
+
+#ifndef _OFX_SLITSCAN_COLD_STORE
+#define _OFX_SLITSCAN_COLD_STORE
+
+#include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class ofxSlitScanColdStore
+{
+  public:
+	typedef std::shared_ptr<const std::vector<unsigned char> > Block;
+	
+	ofxSlitScanColdStore();
+	~ofxSlitScanColdStore();
+	
+	/**
+	 * drops everything and gets ready for slots of frameBytes
+	 * split into blocks of blockBytes
+	 */
+	void setup(int slots, int frameBytes, int blockBytes);
+	void clear();
+	bool isSetup();
+	
+	/**
+	 * number of decompressed blocks kept around between reads
+	 */
+	void setCacheSize(int blocks);
+	
+	/**
+	 * queues the frame in slot for compression. pixels has to stay
+	 * untouched until the slot is collected or cancelled
+	 */
+	void compress(int slot, const unsigned char* pixels);
+	
+	/**
+	 * forgets the slot, waiting for its compression if it is under way.
+	 * Call before writing to a slot again
+	 */
+	void cancel(int slot);
+	
+	/**
+	 * resizes the slots the way ofxSlitScanRing::resize does, so every
+	 * compressed or pending frame keeps its frame. Frames in the slots
+	 * that go are cancelled
+	 */
+	void resizeSlots(int first, int change);
+	
+	/**
+	 * drops every compression that isn't finished and collected,
+	 * waiting for the one under way
+	 */
+	void cancelPending();
+	
+	/**
+	 * moves finished frames in and fills slots with the ones that went
+	 * cold since the last call. Only call from the owning thread
+	 */
+	void collect(std::vector<int>& slots);
+	
+	bool isCold(int slot);
+	bool isPending(int slot);
+	
+	/**
+	 * decompressed rows of a cold slot, safe to call from render threads
+	 */
+	Block getBlock(int slot, int block);
+	int getBlockBytes();
+	
+	/**
+	 * expands a whole cold frame into pixels
+	 */
+	void copyFrame(int slot, unsigned char* pixels);
+	
+	size_t getCompressedBytes();
+	
+  protected:
+	struct Job {
+		int slot;
+		const unsigned char* pixels;
+	};
+	
+	struct CacheEntry {
+		int slot;
+		unsigned int generation;
+		int block;
+		Block pixels;
+	};
+	
+	void workerLoop();
+	void startWorker();
+	void stopWorker();
+	bool decompressBlock(int slot, int block, unsigned char* pixels);
+	
+	int frameBytes;
+	int blockBytes;
+	int blocksPerFrame;
+	
+	//compressed blocks of each slot, empty while a slot is hot
+	std::vector<std::vector<std::vector<unsigned char> > > frames;
+	std::vector<unsigned int> generations;
+	size_t compressedBytes;
+	
+	std::thread worker;
+	std::mutex jobMutex;
+	std::condition_variable jobCondition;
+	std::deque<Job> jobs;
+	int activeSlot;
+	bool stopping;
+	std::vector<std::pair<int, std::vector<std::vector<unsigned char> > > > finished;
+	
+	std::mutex cacheMutex;
+	std::list<CacheEntry> cache;
+	int cacheSize;
+	
+  private:
+	ofxSlitScanColdStore(const ofxSlitScanColdStore&);
+	ofxSlitScanColdStore& operator=(const ofxSlitScanColdStore&);
+};
+
+#endif
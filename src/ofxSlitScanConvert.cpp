@@ -0,0 +1,249 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanConvert.cpp
+ */
+
+#include "ofxSlitScanConvert.h"
+#include <cstring>
+
+static inline unsigned char clip(int value){
+	return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+//the source pixel at x as 4 components, red green blue alpha or luma and the two chroma
+template<int format>
+static inline void readPixel(const unsigned char* row, const unsigned char* chroma, int x, int* c){
+	const unsigned char* p;
+	switch(format){
+		case ofxSlitScanConvert::FORMAT_GRAY:
+			c[0] = c[1] = c[2] = row[x];
+			c[3] = 255;
+			break;
+		case ofxSlitScanConvert::FORMAT_RGB:
+		case ofxSlitScanConvert::FORMAT_BGR:
+			p = row + x * 3;
+			c[0] = p[format == ofxSlitScanConvert::FORMAT_RGB ? 0 : 2];
+			c[1] = p[1];
+			c[2] = p[format == ofxSlitScanConvert::FORMAT_RGB ? 2 : 0];
+			c[3] = 255;
+			break;
+		case ofxSlitScanConvert::FORMAT_RGBA:
+		case ofxSlitScanConvert::FORMAT_BGRA:
+			p = row + x * 4;
+			c[0] = p[format == ofxSlitScanConvert::FORMAT_RGBA ? 0 : 2];
+			c[1] = p[1];
+			c[2] = p[format == ofxSlitScanConvert::FORMAT_RGBA ? 2 : 0];
+			c[3] = p[3];
+			break;
+		case ofxSlitScanConvert::FORMAT_YUYV:
+			//each pair of pixels shares its chroma, Y0 U Y1 V
+			p = row + (x >> 1) * 4;
+			c[0] = row[x * 2];
+			c[1] = p[1];
+			c[2] = p[3];
+			c[3] = 255;
+			break;
+		case ofxSlitScanConvert::FORMAT_NV12:
+			//each 2x2 block of pixels shares its chroma, U V
+			p = chroma + (x >> 1) * 2;
+			c[0] = row[x];
+			c[1] = p[0];
+			c[2] = p[1];
+			c[3] = 255;
+			break;
+	}
+}
+
+//components from readPixel as an output pixel of channels
+template<int format, int channels>
+static inline void writePixel(const int* c, unsigned char* out){
+	if(format == ofxSlitScanConvert::FORMAT_YUYV || format == ofxSlitScanConvert::FORMAT_NV12){
+		//BT.601 video range in 8 bit fixed point
+		int y = (c[0] - 16) * 298 + 128;
+		if(channels == 1){
+			out[0] = clip(y >> 8);
+			return;
+		}
+		int u = c[1] - 128;
+		int v = c[2] - 128;
+		out[0] = clip((y + 409 * v) >> 8);
+		out[1] = clip((y - 100 * u - 208 * v) >> 8);
+		out[2] = clip((y + 516 * u) >> 8);
+	}
+	else{
+		if(channels == 1){
+			//the same luminance weights as the delay maps
+			out[0] = (77 * c[0] + 150 * c[1] + 29 * c[2] + 128) >> 8;
+			return;
+		}
+		out[0] = c[0];
+		out[1] = c[1];
+		out[2] = c[2];
+	}
+	if(channels == 4){
+		out[3] = c[3];
+	}
+}
+
+//where output pixel i of count falls in a source of size, nearest or
+//as a pair of pixels and the weight of the second
+static void samplePositions(int count, int size, bool bilinear, std::vector<int>& first, std::vector<int>& second, std::vector<unsigned short>& weights){
+	first.resize(count);
+	second.resize(count);
+	weights.resize(count);
+	double scale = double(size) / count;
+	for(int i = 0; i < count; i++){
+		double center = (i + .5) * scale;
+		if(!bilinear){
+			first[i] = second[i] = center < size ? int(center) : size - 1;
+			weights[i] = 0;
+			continue;
+		}
+		double position = center - .5;
+		position = position < 0 ? 0 : (position > size - 1 ? size - 1 : position);
+		first[i] = int(position);
+		second[i] = first[i] + 1 < size ? first[i] + 1 : first[i];
+		weights[i] = (unsigned short)((position - first[i]) * 256 + .5);
+	}
+}
+
+ofxSlitScanConvert::ofxSlitScanConvert()
+:width(0), height(0), format(FORMAT_RGB), dstWidth(0), dstHeight(0), dstChannels(0), bilinear(false) {
+}
+
+bool ofxSlitScanConvert::setup(int w, int h, Format _format, int _dstWidth, int _dstHeight, int _dstChannels, bool _bilinear){
+	if(w <= 0 || h <= 0 || _dstWidth <= 0 || _dstHeight <= 0 || _format < FORMAT_GRAY || _format > FORMAT_NV12 ||
+	   (_dstChannels != 1 && _dstChannels != 3 && _dstChannels != 4)){
+		return false;
+	}
+	
+	//frames of the same size aren't filtered
+	_bilinear = _bilinear && (w != _dstWidth || h != _dstHeight);
+	if(w == width && h == height && _format == format && _dstWidth == dstWidth && _dstHeight == dstHeight &&
+	   _dstChannels == dstChannels && _bilinear == bilinear){
+		return true;
+	}
+	width = w;
+	height = h;
+	format = _format;
+	dstWidth = _dstWidth;
+	dstHeight = _dstHeight;
+	dstChannels = _dstChannels;
+	bilinear = _bilinear;
+	samplePositions(dstWidth, width, bilinear, columns, nextColumns, columnWeights);
+	samplePositions(dstHeight, height, bilinear, rows, nextRows, rowWeights);
+	return true;
+}
+
+size_t ofxSlitScanConvert::rowBytes(Format format, int w){
+	switch(format){
+		case FORMAT_GRAY:
+		case FORMAT_NV12:
+			return w;
+		case FORMAT_RGB:
+		case FORMAT_BGR:
+			return w * 3;
+		case FORMAT_RGBA:
+		case FORMAT_BGRA:
+			return w * 4;
+		case FORMAT_YUYV:
+			return (w + 1) / 2 * 4;
+	}
+	return 0;
+}
+
+void ofxSlitScanConvert::convert(const unsigned char* src, size_t stride, unsigned char* dst){
+	if(stride == 0){
+		stride = rowBytes(format, width);
+	}
+	
+	//a frame already in the layout of the history is copied row by row
+	bool sameLayout = (format == FORMAT_GRAY && dstChannels == 1) || (format == FORMAT_RGB && dstChannels == 3) ||
+		(format == FORMAT_RGBA && dstChannels == 4);
+	if(sameLayout && width == dstWidth && height == dstHeight){
+		size_t dstRowBytes = (size_t)dstWidth * dstChannels;
+		for(int y = 0; y < height; y++){
+			memcpy(dst + y * dstRowBytes, src + y * stride, dstRowBytes);
+		}
+		return;
+	}
+	
+	switch(format){
+		case FORMAT_GRAY: convertFormat<FORMAT_GRAY>(src, stride, dst); break;
+		case FORMAT_RGB: convertFormat<FORMAT_RGB>(src, stride, dst); break;
+		case FORMAT_BGR: convertFormat<FORMAT_BGR>(src, stride, dst); break;
+		case FORMAT_RGBA: convertFormat<FORMAT_RGBA>(src, stride, dst); break;
+		case FORMAT_BGRA: convertFormat<FORMAT_BGRA>(src, stride, dst); break;
+		case FORMAT_YUYV: convertFormat<FORMAT_YUYV>(src, stride, dst); break;
+		case FORMAT_NV12: convertFormat<FORMAT_NV12>(src, stride, dst); break;
+	}
+}
+
+template<int format>
+void ofxSlitScanConvert::convertFormat(const unsigned char* src, size_t stride, unsigned char* dst){
+	switch(dstChannels){
+		case 1: bilinear ? convertRows<format, 1, true>(src, stride, dst) : convertRows<format, 1, false>(src, stride, dst); break;
+		case 3: bilinear ? convertRows<format, 3, true>(src, stride, dst) : convertRows<format, 3, false>(src, stride, dst); break;
+		case 4: bilinear ? convertRows<format, 4, true>(src, stride, dst) : convertRows<format, 4, false>(src, stride, dst); break;
+	}
+}
+
+template<int format, int channels, bool bilinear>
+void ofxSlitScanConvert::convertRows(const unsigned char* src, size_t stride, unsigned char* dst){
+	//NV12 chroma rows each cover two luma rows
+	const unsigned char* chromaPlane = src + stride * height;
+	int c[4];
+	for(int y = 0; y < dstHeight; y++){
+		const unsigned char* top = src + rows[y] * stride;
+		const unsigned char* topChroma = chromaPlane + (rows[y] >> 1) * stride;
+		unsigned char* out = dst + (size_t)y * dstWidth * channels;
+		if(!bilinear){
+			for(int x = 0; x < dstWidth; x++){
+				readPixel<format>(top, topChroma, columns[x], c);
+				writePixel<format, channels>(c, out + x * channels);
+			}
+			continue;
+		}
+		
+		//the four source pixels around each output pixel, in the source's own components
+		const unsigned char* bottom = src + nextRows[y] * stride;
+		const unsigned char* bottomChroma = chromaPlane + (nextRows[y] >> 1) * stride;
+		int fy = rowWeights[y];
+		int a[4], b[4], d[4], e[4];
+		for(int x = 0; x < dstWidth; x++){
+			readPixel<format>(top, topChroma, columns[x], a);
+			readPixel<format>(top, topChroma, nextColumns[x], b);
+			readPixel<format>(bottom, bottomChroma, columns[x], d);
+			readPixel<format>(bottom, bottomChroma, nextColumns[x], e);
+			int fx = columnWeights[x];
+			for(int i = 0; i < 4; i++){
+				int upper = a[i] * (256 - fx) + b[i] * fx;
+				int lower = d[i] * (256 - fx) + e[i] * fx;
+				c[i] = (upper * (256 - fy) + lower * fy + 32768) >> 16;
+			}
+			writePixel<format, channels>(c, out + x * channels);
+		}
+	}
+}
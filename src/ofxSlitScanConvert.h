@@ -0,0 +1,92 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanConvert.h
+ *
+ * Scales and converts incoming frames of any size and pixel format to
+ * the size and channels of the history in one pass, so a frame is read
+ * once and written once, straight into its slot.
+ * YUYV and NV12 are taken as BT.601 video range, NV12 chroma follows
+ * the luma plane with the same stride.
+ */
+
+#ifndef _OFX_SLITSCAN_CONVERT
+#define _OFX_SLITSCAN_CONVERT
+
+#include <cstddef>
+#include <vector>
+
+class ofxSlitScanConvert
+{
+  public:
+	enum Format {
+		FORMAT_GRAY,
+		FORMAT_RGB,
+		FORMAT_BGR,
+		FORMAT_RGBA,
+		FORMAT_BGRA,
+		FORMAT_YUYV,
+		FORMAT_NV12
+	};
+	
+	ofxSlitScanConvert();
+	
+	/**
+	 * gets ready to turn w x h frames of format into dstWidth x dstHeight
+	 * frames of dstChannels, 1, 3 or 4. Sources are sampled nearest or
+	 * bilinear. Does nothing if none of it changed.
+	 * returns false if the sizes, format or channels aren't supported
+	 */
+	bool setup(int w, int h, Format format, int dstWidth, int dstHeight, int dstChannels, bool bilinear);
+	
+	/**
+	 * converts src into dst, which holds a tightly packed frame.
+	 * stride is the length of a source row in bytes, 0 for packed rows
+	 */
+	void convert(const unsigned char* src, size_t stride, unsigned char* dst);
+	
+	/**
+	 * bytes in a packed row of w pixels, the luma row for NV12
+	 */
+	static size_t rowBytes(Format format, int w);
+	
+  protected:
+	template<int format, int channels, bool bilinear>
+	void convertRows(const unsigned char* src, size_t stride, unsigned char* dst);
+	template<int format>
+	void convertFormat(const unsigned char* src, size_t stride, unsigned char* dst);
+	
+	int width, height;
+	Format format;
+	int dstWidth, dstHeight, dstChannels;
+	bool bilinear;
+	
+	//source pixels each output pixel reads, the second one and the
+	//weight of it out of 256 only when bilinear
+	std::vector<int> columns, nextColumns;
+	std::vector<int> rows, nextRows;
+	std::vector<unsigned short> columnWeights, rowWeights;
+};
+
+#endif
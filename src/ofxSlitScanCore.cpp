@@ -0,0 +1,2919 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanCore.cpp
+ */
+
+#include "ofxSlitScanCore.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+#ifndef MIN
+	#define MIN(x,y) (((x) < (y)) ? (x) : (y))
+#endif
+#ifndef MAX
+	#define MAX(x,y) (((x) > (y)) ? (x) : (y))
+#endif
+
+//number of rows handed to a render thread at a time
+#define RENDER_BAND_ROWS 16
+
+//number of bucketed pixels handed to a render thread at a time
+#define RENDER_BUCKET_PIXELS 8192
+
+//frames in the history start on cache line boundaries
+#define FRAME_ALIGNMENT 64
+
+//frames read in ahead of the delay window of a file backed history
+#define HISTORY_READAHEAD_FRAMES 2
+
+//rows per compressed block of a cold frame, matches the render bands
+#define COLD_BLOCK_ROWS RENDER_BAND_ROWS
+
+//rendered regions remembered for skipping repeat renders
+#define RENDER_REGION_CACHE 64
+
+//ADMIT_ADAPTIVE never stores fewer than 1 in this many frames
+#define ADMISSION_MAX_EVERY 64
+
+#ifndef TWO_PI
+	#define TWO_PI 6.28318530717958647693
+#endif
+
+//converts from an index (0, capacity) to the appropriate fraem in the rolling buffer
+static inline int frame_index(int framepointer, int index, int capacity){ 
+	framepointer += index;
+    if(framepointer < capacity) {
+        return framepointer;
+    }
+    return framepointer - capacity;
+}
+
+static inline float clamp(float value, float low, float high){
+	return value < low ? low : (value > high ? high : value);
+}
+
+//copies rows between buffers that may be padded differently
+static void copyRows(unsigned char* dst, size_t dstStride, const unsigned char* src, size_t srcStride, size_t rowBytes, int rows){
+	if(dstStride == rowBytes && srcStride == rowBytes){
+		memcpy(dst, src, rowBytes * rows);
+		return;
+	}
+	for(int y = 0; y < rows; y++){
+		memcpy(dst + y * dstStride, src + y * srcStride, rowBytes);
+	}
+}
+
+static inline double now(){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static ofxSlitScanCore::LogFunction logFunction;
+
+static void log(ofxSlitScanCore::LogLevel level, const char* format, ...){
+	char message[1024];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
+	
+	if(logFunction){
+		logFunction(level, message);
+	}
+	else{
+		fprintf(stderr, "%s\n", message);
+	}
+}
+
+//reads pixels of cold frames for one render task, holding on to
+//the last block it expanded for every slot
+class ColdFrameReader {
+  public:
+	ColdFrameReader(ofxSlitScanColdStore& store, int slots)
+	:store(store), blockBytes(store.getBlockBytes()), blockIndices(slots, -1), blocks(slots) {
+	}
+	
+	inline unsigned char* pixel(int slot, int byteIndex){
+		int block = byteIndex / blockBytes;
+		if(blockIndices[slot] != block){
+			blocks[slot] = store.getBlock(slot, block);
+			blockIndices[slot] = block;
+		}
+		return (unsigned char*)&(*blocks[slot])[byteIndex - block * blockBytes];
+	}
+	
+  protected:
+	ofxSlitScanColdStore& store;
+	int blockBytes;
+	vector<int> blockIndices;
+	vector<ofxSlitScanColdStore::Block> blocks;
+};
+
+//source positions for each of outSize samples over inSize pixels, with pixel
+//centers lined up. bilinear samples blend lower and upper by weight / 256
+static void resampleAxis(int outSize, int inSize, bool bilinear, int* lower, int* upper, unsigned char* weights){
+	for(int i = 0; i < outSize; i++){
+		double position = (i + .5) * inSize / outSize;
+		if(bilinear){
+			position = MIN(MAX(position - .5, 0.), double(inSize - 1));
+			lower[i] = int(position);
+			upper[i] = MIN(lower[i] + 1, inSize - 1);
+			weights[i] = MIN(int((position - lower[i]) * 256), 255);
+		}
+		else{
+			lower[i] = upper[i] = MIN(int(position), inSize - 1);
+			weights[i] = 0;
+		}
+	}
+}
+
+//quantizes an 8 bit map to levels, 256 for gray and 65536 for color maps,
+//which keep their luminance precision. false if channels isn't supported
+static bool quantizeMap(const unsigned char* map, int w, int h, int channels, size_t stride,
+						vector<unsigned short>& levels, int& levelCount){
+	if(channels != 1 && channels != 3 && channels != 4){
+		log(ofxSlitScanCore::LOG_ERROR, "ofxSlitScan -- unsupported image map type");
+		return false;
+	}
+	if(stride == 0){
+		stride = w * channels;
+	}
+	levels.resize(w * h);
+	for(int y = 0; y < h; y++){
+		const unsigned char* pix = map + y * stride;
+		unsigned short* row = &levels[y * w];
+		if(channels == 1){
+			for(int x = 0; x < w; x++){
+				row[x] = pix[x];
+			}
+		}
+		else{
+			for(int x = 0; x < w; x++){
+				//RGB 0 - 255 ==> YUV 0 - 65535
+				row[x] = (0.299*pix[x*channels] + 0.587*pix[x*channels+1] + 0.114*pix[x*channels+2]) / 255.0 * 65535 + .5;
+			}
+		}
+	}
+	levelCount = channels == 1 ? 256 : 65536;
+	return true;
+}
+
+//assumed monochrome float map, quantized to 16 bit levels
+static void quantizeMap(const float* map, int w, int h, size_t stride, vector<unsigned short>& levels, int& levelCount){
+	if(stride == 0){
+		stride = w * sizeof(float);
+	}
+	levels.resize(w * h);
+	for(int y = 0; y < h; y++){
+		const float* mappix = (const float*)((const unsigned char*)map + y * stride);
+		unsigned short* row = &levels[y * w];
+		for(int x = 0; x < w; x++){
+			row[x] = clamp(mappix[x], 0, 1) * 65535 + .5;
+		}
+	}
+	levelCount = 65536;
+}
+
+//map levels resampled to another size
+static void resampleLevels(const unsigned short* in, int inWidth, int inHeight, unsigned short* out, int outWidth, int outHeight, bool bilinear){
+	if(inWidth == outWidth && inHeight == outHeight){
+		memcpy(out, in, outWidth * outHeight * sizeof(unsigned short));
+		return;
+	}
+	vector<int> left(outWidth), right(outWidth), top(outHeight), bottom(outHeight);
+	vector<unsigned char> columnWeights(outWidth), rowWeights(outHeight);
+	resampleAxis(outWidth, inWidth, bilinear, &left[0], &right[0], &columnWeights[0]);
+	resampleAxis(outHeight, inHeight, bilinear, &top[0], &bottom[0], &rowWeights[0]);
+	for(int y = 0; y < outHeight; y++){
+		const unsigned short* topRow = in + top[y] * inWidth;
+		const unsigned short* bottomRow = in + bottom[y] * inWidth;
+		unsigned short* levels = out + y * outWidth;
+		unsigned int fy = rowWeights[y];
+		for(int x = 0; x < outWidth; x++){
+			unsigned int fx = columnWeights[x];
+			unsigned int upper = topRow[left[x]] * (256 - fx) + topRow[right[x]] * fx;
+			unsigned int lower = bottomRow[left[x]] * (256 - fx) + bottomRow[right[x]] * fx;
+			levels[x] = ((unsigned long long)upper * (256 - fy) + (unsigned long long)lower * fy + 32768) >> 16;
+		}
+	}
+}
+
+//pixel byteIndex of a frame, going through the cold store when the frame is compressed
+template<bool cold>
+static inline unsigned char* framePixel(unsigned char* frame, int slot, int byteIndex, ColdFrameReader& reader){
+	if(cold && frame == NULL){
+		return reader.pixel(slot, byteIndex);
+	}
+	return frame + byteIndex;
+}
+
+//one output pixel resampled from a frame. top and bottom are the byte
+//offsets of the source rows, left and right of the source pixels in them
+template<int channels, bool cold, bool bilinear>
+static inline void resamplePixel(unsigned char* frame, int slot, int top, int bottom, int left, int right,
+								 unsigned int fx, unsigned int fy, ColdFrameReader& reader, unsigned char* out){
+	unsigned char* a = framePixel<cold>(frame, slot, top + left, reader);
+	if(!bilinear){
+		for(int c = 0; c < channels; c++) {
+			out[c] = a[c];
+		}
+		return;
+	}
+	
+	//finish with the top row before the cold reader moves on to the bottom one
+	unsigned char* b = framePixel<cold>(frame, slot, top + right, reader);
+	unsigned int upper[channels];
+	for(int c = 0; c < channels; c++) {
+		upper[c] = a[c] * (256 - fx) + b[c] * fx;
+	}
+	a = framePixel<cold>(frame, slot, bottom + left, reader);
+	b = framePixel<cold>(frame, slot, bottom + right, reader);
+	for(int c = 0; c < channels; c++) {
+		unsigned int lower = a[c] * (256 - fx) + b[c] * fx;
+		out[c] = (upper[c] * (256 - fy) + lower * fy + 32768) >> 16;
+	}
+}
+
+void ofxSlitScanCore::setLogFunction(LogFunction log){
+	logFunction = log;
+}
+
+ofxSlitScanCore::ofxSlitScanCore()
+:reservedCapacity(0), historyGeneration(0), admission(ADMIT_ALL), admissionAmount(0), admittedEvery(1), admitCountdown(0),
+ frameAdmitted(true), nextAdmitTime(0), admittedAt(0), admissionCost(0), admissionRenderSeconds(0),
+ ingestDepth(0), ingestPolicy(ofxSlitScanIngestQueue::DROP_OLDEST), pinnedReplacement(NULL), mapIsProcedural(false),
+ outputIsDirty(false), outputBuffer(NULL), callerBuffer(NULL), outputVersion(0), changeVersion(0),
+ asyncRendering(false), asyncAllowsLatency(true), renderRunning(false), renderStopping(false), renderReadsOldest(true),
+ bytesPerFrame(0), buffersAllocated(false) {
+}
+
+ofxSlitScanCore::~ofxSlitScanCore(){
+	stopRenderThread();
+	if(buffersAllocated){
+		releaseAllSlots();
+		free(delayMapLevels);
+	}
+	releasePinnedFrames();
+	delete[] pinnedReplacement;
+}
+
+void ofxSlitScanCore::setup(int w, int h, int _capacity, int channels) {
+	if(channels != 1 && channels != 3 && channels != 4){
+		log(LOG_ERROR, "ofxSlitScan Error -- Invalid channel count %d", channels);
+		return;
+	}
+	bytesPerPixel = channels;
+    
+	//clean up if reallocating
+	waitForRender();
+	if(buffersAllocated){
+		coldFrames.clear();
+		releaseAllSlots();
+		releasePinnedFrames();
+		delete[] pinnedReplacement;
+		pinnedReplacement = NULL;
+		free(delayMapLevels);
+		releaseHistory();
+		emptyFrame.release();
+		retainedFrames.release();
+		buffersAllocated = false;
+	}
+	
+	width = w;
+	height = h;
+	capacity = _capacity;
+	framepointer = 0;
+	framesAdded = 0;
+	resetStats();
+	blend = false;
+	bucketed = false;
+	sparseRetention = false;
+	retainedStarts.clear();
+	coldAge = 0;
+	thumbnailWidth = thumbnailHeight = thumbnailBytes = 0;
+	vector<unsigned char>().swap(thumbnails);
+	namedOutputs.clear();
+	admittedEvery = 1;
+	admitCountdown = 0;
+	frameAdmitted = true;
+	nextAdmitTime = admissionCost = admissionRenderSeconds = 0;
+	vector<unsigned char>().swap(skippedFrame);
+	timeDelay = 0;
+	timeWidth = capacity;
+	bytesPerFrame = width*height*bytesPerPixel;
+	ingestQueue.setup(ingestDepth, bytesPerFrame, ingestPolicy);
+	frameStride = (bytesPerFrame + FRAME_ALIGNMENT - 1) / FRAME_ALIGNMENT * FRAME_ALIGNMENT;
+	
+	//nothing is committed here, pages come in as frames are written
+	if(!reserveHistory() || !emptyFrame.allocate(frameStride)){
+		log(LOG_ERROR, "ofxSlitScan Error -- Could not reserve %d frames of %d bytes", capacity, bytesPerFrame);
+		releaseHistory();
+		emptyFrame.release();
+		return;
+	}
+	emptyFrame.commit(0, frameStride);
+	frameWritten.assign(capacity, false);
+	adoptedFrames.assign(capacity, (unsigned char*)NULL);
+	adoptedReleases.assign(capacity, ReleaseCallback());
+	resetFrameIds();
+	
+	//the output starts out the size of the history
+	outputWidth = w;
+	outputHeight = h;
+	outputBytes = bytesPerFrame;
+	resampling = RESAMPLE_BILINEAR;
+	updateResampling();
+	
+	mapWidth = w;
+	mapHeight = h;
+	mapLevels.assign(w*h, 0);
+	mapIsProcedural = false;
+	delayMapLevels = (unsigned short*)calloc(w*h, sizeof(unsigned short));
+	delayMapLevelCount = 256;
+	levelPixelCountsAreDirty = true;
+	outputPixels.assign(outputBytes, 0);
+	outputBuffer = &outputPixels[0];
+	callerBuffer = NULL;
+	if(asyncRendering){
+		frontPixels.assign(outputBytes, 0);
+		backPixels.assign(outputBytes, 0);
+	}
+	buffersAllocated = true;
+	markOutputDirty();
+	delayLUTIsDirty = true;
+	bucketsAreDirty = true;
+}
+
+bool ofxSlitScanCore::isSetup(){
+	return buffersAllocated;
+}
+
+void ofxSlitScanCore::setCapacity(int _capacity){
+	waitForRender();
+	if(_capacity <= 0){
+		_capacity = 1;
+	}
+	
+	if(_capacity == capacity){
+		return;
+	}
+	
+	//the retained history is rebuilt from the new table when it is next used
+	if(sparseRetention){
+		frameWritten.assign(_capacity, false);
+		adoptedFrames.assign(_capacity, (unsigned char*)NULL);
+		adoptedReleases.assign(_capacity, ReleaseCallback());
+		//thumbnails keep their age, like the retained history
+		vector<unsigned char> resized((size_t)_capacity * thumbnailBytes, 0);
+		for(int age = 0; age < MIN(capacity, _capacity) && thumbnailBytes > 0; age++){
+			memcpy(&resized[frame_index(framepointer % _capacity, _capacity - 1 - age, _capacity) * thumbnailBytes],
+				   &thumbnails[frame_index(framepointer, capacity - 1 - age, capacity) * thumbnailBytes], thumbnailBytes);
+		}
+		thumbnails.swap(resized);
+		framepointer %= _capacity;
+		capacity = _capacity;
+		resetFrameIds();
+		markOutputDirty();
+		delayLUTIsDirty = true;
+		return;
+	}
+	
+	resizeHistory(_capacity);
+}
+
+void ofxSlitScanCore::reserveCapacity(int frames){
+	waitForRender();
+	reservedCapacity = MAX(frames, 0);
+	
+	//the sparse history reserves its cells when it goes back to a ring
+	if(!buffersAllocated || sparseRetention){
+		return;
+	}
+	int missing = reservedCapacity - int(slotCells.size() + freeCells.size());
+	if(missing > 0 && !addHistoryBlock(missing)){
+		log(LOG_ERROR, "ofxSlitScan -- Could not reserve %d frames of %d bytes", missing, bytesPerFrame);
+	}
+}
+
+int ofxSlitScanCore::getReservedCapacity(){
+	return reservedCapacity;
+}
+
+bool ofxSlitScanCore::allocateHistory(ofxSlitScanArena& arena, int slots){
+	if(historyDirectory.empty()){
+		return arena.allocate(frameStride * slots);
+	}
+	return arena.allocateFile(frameStride * slots, historyDirectory);
+}
+
+bool ofxSlitScanCore::reserveHistory(){
+	releaseHistory();
+	if(!addHistoryBlock(MAX(capacity, reservedCapacity))){
+		return false;
+	}
+	for(int slot = 0; slot < capacity; slot++){
+		slotCells.push_back(freeCells.back());
+		freeCells.pop_back();
+	}
+	return true;
+}
+
+bool ofxSlitScanCore::addHistoryBlock(int cells){
+	std::shared_ptr<ofxSlitScanArena> block(new ofxSlitScanArena());
+	if(cells <= 0 || !allocateHistory(*block, cells)){
+		return false;
+	}
+	frameBlocks.push_back(block);
+	
+	//cells are handed out from the back, so the first ones go first
+	for(int i = cells - 1; i >= 0; i--){
+		Cell cell = {block.get(), i * frameStride};
+		freeCells.push_back(cell);
+	}
+	reserveSlots();
+	return true;
+}
+
+void ofxSlitScanCore::releaseHistory(){
+	slotCells.clear();
+	freeCells.clear();
+	frameBlocks.clear();
+}
+
+void ofxSlitScanCore::reserveSlots(){
+	//so the slots can grow into every cell without reallocating
+	size_t cells = slotCells.size() + freeCells.size();
+	slotCells.reserve(cells);
+	frameWritten.reserve(cells);
+	adoptedFrames.reserve(cells);
+	adoptedReleases.reserve(cells);
+	slotFrameIds.reserve(cells);
+	slotVersions.reserve(cells);
+	arenaFrameIds.reserve(cells);
+	slotTimes.reserve(cells);
+	thumbnails.reserve(cells * thumbnailBytes);
+}
+
+void ofxSlitScanCore::resizeSlots(int first, int change){
+	Cell noCell = {NULL, 0};
+	ofxSlitScanRing::resize(slotCells, first, change, noCell);
+	ofxSlitScanRing::resize(frameWritten, first, change, false);
+	ofxSlitScanRing::resize(adoptedFrames, first, change, (unsigned char*)NULL);
+	ofxSlitScanRing::resize(adoptedReleases, first, change, ReleaseCallback());
+	ofxSlitScanRing::resize(slotFrameIds, first, change, 0ULL);
+	ofxSlitScanRing::resize(slotVersions, first, change, 0ULL);
+	ofxSlitScanRing::resize(arenaFrameIds, first, change, 0ULL);
+	ofxSlitScanRing::resize(slotTimes, first, change, 0.0);
+	ofxSlitScanRing::resize(thumbnails, first, change, (unsigned char)0, thumbnailBytes);
+	
+	//compressed frames follow their slots
+	if(coldFrames.isSetup()){
+		coldFrames.resizeSlots(first, change);
+	}
+}
+
+bool ofxSlitScanCore::resizeHistory(int _capacity){
+	//past the reserved cells another block is reserved, the frames already kept stay where they are
+	int missing = _capacity - capacity - int(freeCells.size());
+	if(missing > 0 && !addHistoryBlock(missing)){
+		log(LOG_ERROR, "ofxSlitScan -- Could not reserve %d frames of %d bytes", missing, bytesPerFrame);
+		return false;
+	}
+	
+	//turn the ring so the oldest frame is in slot 0, the next one written
+	resizeSlots(framepointer, 0);
+	framepointer = 0;
+	
+	//shrinking lets the oldest frames go and hands their cells back
+	int change = _capacity - capacity;
+	for(int slot = 0; slot < -change; slot++){
+		releaseSlot(slot);
+		if(frameWritten[slot]){
+			slotCells[slot].block->decommit(slotCells[slot].offset, bytesPerFrame);
+		}
+		freeCells.push_back(slotCells[slot]);
+	}
+	
+	//growing puts empty frames in front of the oldest
+	resizeSlots(0, change);
+	for(int slot = 0; slot < change; slot++){
+		slotCells[slot] = freeCells.back();
+		freeCells.pop_back();
+	}
+	capacity = _capacity;
+	
+	//views know their frames by slot
+	historyGeneration++;
+	markOutputDirty();
+	delayLUTIsDirty = true;
+	return true;
+}
+
+bool ofxSlitScanCore::moveHistory(){
+	std::shared_ptr<ofxSlitScanArena> moved(new ofxSlitScanArena());
+	int cells = int(slotCells.size() + freeCells.size());
+	if(!allocateHistory(*moved, cells)){
+		log(LOG_ERROR, "ofxSlitScan -- Could not reserve %d frames of %d bytes", cells, bytesPerFrame);
+		return false;
+	}
+	
+	//compressed frames stay in the cold store as they are. Frames still
+	//being compressed read from the old cells, so they start over after
+	if(coldFrames.isSetup()){
+		collectColdFrames();
+		coldFrames.cancelPending();
+	}
+	
+	//every slot keeps its frame, in the cell of the new block with its index
+	for(int slot = 0; slot < capacity; slot++){
+		Cell cell = {moved.get(), slot * frameStride};
+		if(frameWritten[slot]){
+			moved->commit(cell.offset, bytesPerFrame);
+			memcpy(moved->getData() + cell.offset, cellPixels(slot), bytesPerFrame);
+		}
+		slotCells[slot] = cell;
+	}
+	freeCells.clear();
+	for(int i = cells - 1; i >= capacity; i--){
+		Cell cell = {moved.get(), i * frameStride};
+		freeCells.push_back(cell);
+	}
+	frameBlocks.assign(1, moved);
+	
+	//views into the old history are stale now
+	historyGeneration++;
+	arenaFrameIds.assign(capacity, 0);
+	markOutputDirty();
+	delayLUTIsDirty = true;
+	
+	for(int age = coldAge; coldAge > 0 && age < capacity; age++){
+		queueColdFrame(age);
+	}
+	return true;
+}
+
+bool ofxSlitScanCore::isHistoryFileBacked(){
+	return !frameBlocks.empty() && frameBlocks[0]->isFileBacked();
+}
+
+void ofxSlitScanCore::setDelayMap(const unsigned char* map, int channels, size_t stride){
+	setDelayMap(map, outputWidth, outputHeight, channels, stride);
+}
+
+void ofxSlitScanCore::setDelayMap(const unsigned char* map, int w, int h, int channels, size_t stride){
+	waitForRender();
+	if(w <= 0 || h <= 0){
+		log(LOG_ERROR, "ofxSlitScan -- Invalid map size %dx%d", w, h);
+		return;
+	}
+	if(!quantizeMap(map, w, h, channels, stride, mapLevels, delayMapLevelCount)){
+		return;
+	}
+	mapIsProcedural = false;
+	mapWidth = w;
+	mapHeight = h;
+	updateOutputMap();
+}
+
+void ofxSlitScanCore::setDelayMap(const float* map, size_t stride){
+	setDelayMap(map, outputWidth, outputHeight, stride);
+}
+
+void ofxSlitScanCore::setDelayMap(const float* map, int w, int h, size_t stride){
+	waitForRender();
+	if(w <= 0 || h <= 0){
+		log(LOG_ERROR, "ofxSlitScan -- Invalid map size %dx%d", w, h);
+		return;
+	}
+	quantizeMap(map, w, h, stride, mapLevels, delayMapLevelCount);
+	mapIsProcedural = false;
+	mapWidth = w;
+	mapHeight = h;
+	updateOutputMap();
+}
+
+void ofxSlitScanCore::updateOutputMap(){
+	//resampled to the output with the output's filter,
+	//procedural maps are evaluated at whatever size the output is
+	if(mapIsProcedural){
+		proceduralMapIsStored = false;
+	}
+	else{
+		resampleLevels(&mapLevels[0], mapWidth, mapHeight, delayMapLevels, outputWidth, outputHeight, resampling == RESAMPLE_BILINEAR);
+	}
+	levelPixelCountsAreDirty = true;
+	delayLUTIsDirty = true;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::setDelayMap(const ProceduralMap& map){
+	waitForRender();
+	if(!buffersAllocated){
+		return;
+	}
+	proceduralMap = map;
+	mapIsProcedural = true;
+	proceduralMapIsStored = false;
+	
+	//only the table for 16 bit levels has to be built, once
+	if(delayMapLevelCount != 65536){
+		delayMapLevelCount = 65536;
+		delayLUTIsDirty = true;
+	}
+	levelPixelCountsAreDirty = true;
+	bucketsAreDirty = true;
+	markOutputDirty();
+}
+
+bool ofxSlitScanCore::isDelayMapProcedural(){
+	return mapIsProcedural;
+}
+
+void ofxSlitScanCore::proceduralRow(int y, int left, int right, unsigned short* levels){
+	//pixel centers relative to the first point, in output pixels
+	const ProceduralMap& map = proceduralMap;
+	double startX = map.x0 * outputWidth;
+	double startY = map.y0 * outputHeight;
+	double dx = map.x1 * outputWidth - startX;
+	double dy = map.y1 * outputHeight - startY;
+	double length2 = MAX(dx * dx + dy * dy, 1e-6);
+	double px = left + .5 - startX;
+	double py = y + .5 - startY;
+	int n = right - left;
+	
+	switch(map.shape){
+		case MAP_LINEAR:{
+			//the position along the gradient goes up by the same step every pixel
+			double t = (px * dx + py * dy) / length2;
+			double step = dx / length2;
+			for(int i = 0; i < n; i++){
+				levels[i] = MIN(MAX(t, 0.), 1.) * 65535 + .5;
+				t += step;
+			}
+		}break;
+			
+		case MAP_RADIAL:{
+			//the squared distance goes up by 2x + 1 every pixel
+			double distance2 = px * px + py * py;
+			for(int i = 0; i < n; i++){
+				levels[i] = MIN(sqrt(distance2 / length2), 1.) * 65535 + .5;
+				distance2 += 2 * px + 1;
+				px += 1;
+			}
+		}break;
+			
+		case MAP_ANGULAR:{
+			double start = atan2(dy, dx);
+			for(int i = 0; i < n; i++){
+				double turns = (atan2(py, px) - start) / TWO_PI;
+				levels[i] = (turns - floor(turns)) * 65535 + .5;
+				px += 1;
+			}
+		}break;
+			
+		case MAP_SINE:{
+			//rotate the phase one pixel's step at a time instead of calling sin per pixel
+			double t = (px * dx + py * dy) / length2;
+			double phase = TWO_PI * map.frequency * t + map.phase;
+			double step = TWO_PI * map.frequency * dx / length2;
+			double sine = sin(phase), cosine = cos(phase);
+			double stepSine = sin(step), stepCosine = cos(step);
+			for(int i = 0; i < n; i++){
+				levels[i] = MIN(MAX(.5 + .5 * sine, 0.), 1.) * 65535 + .5;
+				double nextSine = sine * stepCosine + cosine * stepSine;
+				cosine = cosine * stepCosine - sine * stepSine;
+				sine = nextSine;
+			}
+		}break;
+	}
+}
+
+void ofxSlitScanCore::proceduralLevelRange(int& lowest, int& highest){
+	lowest = 0;
+	highest = 65535;
+	const ProceduralMap& map = proceduralMap;
+	double startX = map.x0 * outputWidth;
+	double startY = map.y0 * outputHeight;
+	double dx = map.x1 * outputWidth - startX;
+	double dy = map.y1 * outputHeight - startY;
+	double length2 = MAX(dx * dx + dy * dy, 1e-6);
+	
+	//gradients are lowest and highest at the corners, distances at the
+	//corners and the nearest pixel to the first point
+	double cornersX[2] = {.5 - startX, outputWidth - .5 - startX};
+	double cornersY[2] = {.5 - startY, outputHeight - .5 - startY};
+	if(map.shape == MAP_LINEAR){
+		double low = 1, high = 0;
+		for(int i = 0; i < 4; i++){
+			double t = (cornersX[i % 2] * dx + cornersY[i / 2] * dy) / length2;
+			low = MIN(low, t);
+			high = MAX(high, t);
+		}
+		lowest = MIN(MAX(low, 0.), 1.) * 65535;
+		highest = MIN(MAX(high, 0.), 1.) * 65535 + 1;
+	}
+	else if(map.shape == MAP_RADIAL){
+		double nearX = MIN(MAX(0., cornersX[0]), cornersX[1]);
+		double nearY = MIN(MAX(0., cornersY[0]), cornersY[1]);
+		double far2 = 0;
+		for(int i = 0; i < 4; i++){
+			far2 = MAX(far2, cornersX[i % 2] * cornersX[i % 2] + cornersY[i / 2] * cornersY[i / 2]);
+		}
+		lowest = MIN(sqrt((nearX * nearX + nearY * nearY) / length2), 1.) * 65535;
+		highest = MIN(sqrt(far2 / length2), 1.) * 65535 + 1;
+	}
+	lowest = MAX(lowest - 1, 0);
+	highest = MIN(highest, 65535);
+}
+
+void ofxSlitScanCore::storeProceduralMap(){
+	if(!mapIsProcedural || proceduralMapIsStored){
+		return;
+	}
+	for(int y = 0; y < outputHeight; y++){
+		proceduralRow(y, 0, outputWidth, delayMapLevels + y * outputWidth);
+	}
+	proceduralMapIsStored = true;
+}
+
+void ofxSlitScanCore::setOutputSize(int w, int h, Resampling _resampling){
+	waitForRender();
+	if(!buffersAllocated){
+		return;
+	}
+	if(w <= 0 || h <= 0){
+		log(LOG_ERROR, "ofxSlitScan -- Invalid output size %dx%d", w, h);
+		return;
+	}
+	if(sparseRetention && (w != width || h != height)){
+		log(LOG_ERROR, "ofxSlitScan -- The output has to be the size of the history with sparse retention on");
+		return;
+	}
+	if(w == outputWidth && h == outputHeight && _resampling == resampling){
+		return;
+	}
+	
+	outputWidth = w;
+	outputHeight = h;
+	outputBytes = w * h * bytesPerPixel;
+	resampling = _resampling;
+	updateResampling();
+	
+	//the caller's buffer is the wrong size now
+	outputPixels.assign(outputBytes, 0);
+	callerBuffer = NULL;
+	if(asyncRendering){
+		frontPixels.assign(outputBytes, 0);
+		backPixels.assign(outputBytes, 0);
+	}
+	else{
+		outputBuffer = &outputPixels[0];
+	}
+	
+	free(delayMapLevels);
+	delayMapLevels = (unsigned short*)calloc(w*h, sizeof(unsigned short));
+	bucketsAreDirty = true;
+	renderedRegions.clear();
+	updateOutputMap();
+}
+
+int ofxSlitScanCore::getOutputWidth(){
+	return outputWidth;
+}
+
+int ofxSlitScanCore::getOutputHeight(){
+	return outputHeight;
+}
+
+ofxSlitScanCore::Resampling ofxSlitScanCore::getResampling(){
+	return resampling;
+}
+
+void ofxSlitScanCore::updateResampling(){
+	outputIsResampled = outputWidth != width || outputHeight != height;
+	bool bilinear = resampling == RESAMPLE_BILINEAR;
+	resampleLeft.resize(outputWidth);
+	resampleRight.resize(outputWidth);
+	resampleColumnWeights.resize(outputWidth);
+	resampleTop.resize(outputHeight);
+	resampleBottom.resize(outputHeight);
+	resampleRowWeights.resize(outputHeight);
+	resampleAxis(outputWidth, width, bilinear, &resampleLeft[0], &resampleRight[0], &resampleColumnWeights[0]);
+	resampleAxis(outputHeight, height, bilinear, &resampleTop[0], &resampleBottom[0], &resampleRowWeights[0]);
+	
+	//store byte offsets into the frame
+	for(int x = 0; x < outputWidth; x++){
+		resampleLeft[x] *= bytesPerPixel;
+		resampleRight[x] *= bytesPerPixel;
+	}
+	for(int y = 0; y < outputHeight; y++){
+		resampleTop[y] *= width * bytesPerPixel;
+		resampleBottom[y] *= width * bytesPerPixel;
+	}
+}
+
+void ofxSlitScanCore::setTransferCurve(const vector<float>& curve){
+	waitForRender();
+	transferCurve = curve;
+	delayLUTIsDirty = true;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::setBlending(bool _blend){
+	waitForRender();
+	blend = _blend;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::toggleBlending(){
+	waitForRender();
+	blend = !blend;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::setBucketedRendering(bool _bucketed){
+	waitForRender();
+	bucketed = _bucketed;
+	markOutputDirty();
+}
+
+bool ofxSlitScanCore::isBucketedRendering(){
+	return bucketed;
+}
+
+void ofxSlitScanCore::setNumThreads(int numThreads){
+	waitForRender();
+	threadPool.setNumThreads(numThreads);
+}
+
+int ofxSlitScanCore::getNumThreads(){
+	return threadPool.getNumThreads();
+}
+
+void ofxSlitScanCore::addFrame(const unsigned char* pixels, size_t stride){
+	//frames the admission policy turns away aren't copied at all
+	if(!offerFrame()){
+		return;
+	}
+	
+	//write the image into the buffer
+	double start = now();
+	int rowBytes = width * bytesPerPixel;
+	copyRows(beginAdmittedFrame(), rowBytes, pixels, stride == 0 ? rowBytes : stride, rowBytes, height);
+	stats.ingestSeconds += now() - start;
+	commitFrame();
+}
+
+void ofxSlitScanCore::addFrame(const unsigned char* pixels, int w, int h, PixelFormat format, size_t stride, Resampling resampling){
+	if(!ingestConvert.setup(w, h, format, width, height, bytesPerPixel, resampling == RESAMPLE_BILINEAR)){
+		log(LOG_ERROR, "ofxSlitScan -- Can't add a %dx%d frame of format %d", w, h, int(format));
+		return;
+	}
+	if(!offerFrame()){
+		return;
+	}
+	
+	//scale and convert straight into the slot, no staging frame
+	double start = now();
+	ingestConvert.convert(pixels, stride, beginAdmittedFrame());
+	stats.ingestSeconds += now() - start;
+	commitFrame();
+}
+
+unsigned char* ofxSlitScanCore::beginFrame(){
+	//a frame that won't be stored is written somewhere it is thrown away
+	frameAdmitted = offerFrame();
+	if(!frameAdmitted){
+		skippedFrame.resize(bytesPerFrame);
+		return &skippedFrame[0];
+	}
+	return beginAdmittedFrame();
+}
+
+unsigned char* ofxSlitScanCore::beginAdmittedFrame(){
+	//sparse history takes what it keeps out of a staging frame on commit
+	if(sparseRetention){
+		return &retainedStaging[0];
+	}
+	
+	//the oldest frame is about to be replaced
+	if(renderReadsOldest){
+		waitForRender();
+	}
+	releaseSlot(framepointer);
+	
+	//a pinned frame keeps its slot, the new one goes in a buffer of its own
+	if(pinnedFrames.count(arenaFrameIds[framepointer]) > 0){
+		if(pinnedReplacement == NULL){
+			pinnedReplacement = new unsigned char[bytesPerFrame];
+		}
+		return pinnedReplacement;
+	}
+	
+	if(!frameWritten[framepointer]){
+		slotCells[framepointer].block->commit(slotCells[framepointer].offset, bytesPerFrame);
+		frameWritten[framepointer] = true;
+	}
+	return cellPixels(framepointer);
+}
+
+void ofxSlitScanCore::commitFrame(){
+	if(!frameAdmitted){
+		frameAdmitted = true;
+		return;
+	}
+	waitForRender();
+	double start = now();
+	if(sparseRetention){
+		writeRetainedFrame(&retainedStaging[0]);
+		advanceFrame(&retainedStaging[0]);
+	}
+	else if(pinnedReplacement != NULL){
+		//stands in for the slot like an adopted frame until it is overwritten
+		unsigned char* image = pinnedReplacement;
+		pinnedReplacement = NULL;
+		adoptedFrames[framepointer] = image;
+		adoptedReleases[framepointer] = [](unsigned char* image){
+			delete[] image;
+		};
+		advanceFrame(image);
+	}
+	else{
+		arenaFrameIds[framepointer] = framesAdded + 1;
+		advanceFrame(cellPixels(framepointer));
+	}
+	stats.commitSeconds += now() - start;
+}
+
+void ofxSlitScanCore::advanceFrame(const unsigned char* pixels){
+	framesAdded++;
+	stats.framesAdded++;
+	
+	//increment the framepointer
+	int writtenSlot = framepointer;
+	framepointer = ( (framepointer + 1) % capacity );	
+	slotFrameIds[writtenSlot] = framesAdded;
+	slotVersions[writtenSlot]++;
+	slotTimes[writtenSlot] = now();
+	
+	//every frame moves the others in time when they come in unevenly
+	if(admission == ADMIT_ADAPTIVE){
+		adaptAdmission();
+	}
+	if(isRetimed()){
+		delayLUTIsDirty = true;
+	}
+	
+	if(thumbnailBytes > 0){
+		updateThumbnail(writtenSlot, pixels);
+	}
+	
+	if(isHistoryFileBacked()){
+		adviseNewFrame(writtenSlot);
+	}
+	
+	//one more frame just got old enough to compress
+	if(coldAge > 0){
+		collectColdFrames();
+		queueColdFrame(coldAge);
+	}
+	
+	markOutputDirty();
+	
+	//render the new frame in the background straight away
+	if(asyncRendering){
+		startRender();
+	}
+}
+
+void ofxSlitScanCore::setColdCompression(int age){
+	waitForRender();
+	if(age < 0){
+		age = 0;
+	}
+	if(age > 0 && sparseRetention){
+		log(LOG_WARNING, "ofxSlitScan -- cold compression only applies to the full history, not sparse retention");
+		return;
+	}
+	if(age == coldAge){
+		return;
+	}
+	
+	thawColdFrames();
+	coldAge = age;
+	if(coldAge > 0){
+		coldFrames.setup(capacity, bytesPerFrame, COLD_BLOCK_ROWS * width * bytesPerPixel);
+		for(int frameAge = coldAge; frameAge < capacity; frameAge++){
+			queueColdFrame(frameAge);
+		}
+	}
+	markOutputDirty();
+}
+
+int ofxSlitScanCore::getColdCompression(){
+	return coldAge;
+}
+
+void ofxSlitScanCore::setColdCacheSize(int blocks){
+	waitForRender();
+	coldFrames.setCacheSize(blocks);
+}
+
+void ofxSlitScanCore::queueColdFrame(int age){
+	if(age >= capacity){
+		return;
+	}
+	int slot = frame_index(framepointer, capacity - 1 - age, capacity);
+	
+	//caller owned and pinned frames stay as they are
+	if(!frameWritten[slot] || adoptedFrames[slot] != NULL || coldFrames.isCold(slot) || coldFrames.isPending(slot) ||
+	   pinnedFrames.count(arenaFrameIds[slot]) > 0){
+		return;
+	}
+	coldFrames.compress(slot, cellPixels(slot));
+}
+
+void ofxSlitScanCore::collectColdFrames(){
+	coldFrames.collect(coldCollected);
+	for(size_t i = 0; i < coldCollected.size(); i++){
+		int slot = coldCollected[i];
+		slotCells[slot].block->decommit(slotCells[slot].offset, bytesPerFrame);
+		frameWritten[slot] = false;
+		slotVersions[slot]++;
+	}
+}
+
+void ofxSlitScanCore::thawColdFrames(){
+	if(!coldFrames.isSetup()){
+		return;
+	}
+	collectColdFrames();
+	for(int slot = 0; slot < capacity; slot++){
+		if(coldFrames.isCold(slot)){
+			slotCells[slot].block->commit(slotCells[slot].offset, bytesPerFrame);
+			coldFrames.copyFrame(slot, cellPixels(slot));
+			frameWritten[slot] = true;
+			slotVersions[slot]++;
+		}
+	}
+	coldFrames.clear();
+}
+
+void ofxSlitScanCore::adoptFrame(unsigned char* image, ReleaseCallback release){
+	if(!offerFrame()){
+		if(release){
+			release(image);
+		}
+		return;
+	}
+	waitForRender();
+	double start = now();
+	
+	//sparse history copies out what it keeps so the frame can go straight back
+	if(sparseRetention){
+		writeRetainedFrame(image);
+		advanceFrame(image);
+		if(release){
+			release(image);
+		}
+	}
+	else{
+		releaseSlot(framepointer);
+		adoptedFrames[framepointer] = image;
+		adoptedReleases[framepointer] = release;
+		advanceFrame(image);
+	}
+	stats.commitSeconds += now() - start;
+}
+
+void ofxSlitScanCore::setAdmission(Admission _admission, double amount){
+	waitForRender();
+	if((_admission == ADMIT_EVERY || _admission == ADMIT_FRAME_RATE || _admission == ADMIT_ADAPTIVE) && amount <= 0){
+		log(LOG_ERROR, "ofxSlitScan -- Admission needs an amount above 0, got %f", amount);
+		return;
+	}
+	admission = _admission;
+	admissionAmount = amount;
+	admittedEvery = admission == ADMIT_EVERY ? MAX(int(amount + .5), 1) : 1;
+	admitCountdown = 0;
+	nextAdmitTime = admissionCost = admissionRenderSeconds = 0;
+	delayLUTIsDirty = true;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::setIngestQueue(int depth, IngestPolicy policy){
+	ingestDepth = MAX(depth, 0);
+	ingestPolicy = policy;
+	
+	//frames still waiting go in before the queue is remade
+	if(buffersAllocated){
+		takeQueuedFrames();
+		ingestQueue.setup(ingestDepth, bytesPerFrame, ingestPolicy);
+	}
+}
+
+void ofxSlitScanCore::closeIngestQueue(){
+	ingestQueue.close();
+}
+
+unsigned char* ofxSlitScanCore::beginQueuedFrame(){
+	if(!ingestQueue.isSetup()){
+		log(LOG_ERROR, "ofxSlitScan -- No ingest queue, call setIngestQueue after setup");
+	}
+	return ingestQueue.beginPush();
+}
+
+bool ofxSlitScanCore::commitQueuedFrame(){
+	return ingestQueue.commitPush();
+}
+
+bool ofxSlitScanCore::queueFrame(const unsigned char* pixels, size_t stride){
+	unsigned char* frame = beginQueuedFrame();
+	if(frame == NULL){
+		return false;
+	}
+	int rowBytes = width * bytesPerPixel;
+	copyRows(frame, rowBytes, pixels, stride == 0 ? rowBytes : stride, rowBytes, height);
+	return commitQueuedFrame();
+}
+
+bool ofxSlitScanCore::queueFrame(const unsigned char* pixels, int w, int h, PixelFormat format, size_t stride, Resampling resampling){
+	if(!queueConvert.setup(w, h, format, width, height, bytesPerPixel, resampling == RESAMPLE_BILINEAR)){
+		log(LOG_ERROR, "ofxSlitScan -- Can't queue a %dx%d frame of format %d", w, h, int(format));
+		return false;
+	}
+	unsigned char* frame = beginQueuedFrame();
+	if(frame == NULL){
+		return false;
+	}
+	
+	//converted on the producer thread, the owning one only copies it in
+	queueConvert.convert(pixels, stride, frame);
+	return commitQueuedFrame();
+}
+
+int ofxSlitScanCore::takeQueuedFrames(){
+	stats.framesDropped += ingestQueue.takeDropped();
+	
+	//no more than a queue's worth, so a producer that keeps pace
+	//can't hold the caller here
+	int taken = 0;
+	const unsigned char* pixels;
+	while(taken < ingestDepth && (pixels = ingestQueue.beginPop()) != NULL){
+		addFrame(pixels);
+		ingestQueue.endPop();
+		taken++;
+	}
+	return taken;
+}
+
+ofxSlitScanCore::Admission ofxSlitScanCore::getAdmission(){
+	return admission;
+}
+
+int ofxSlitScanCore::getAdmittedEvery(){
+	return admittedEvery;
+}
+
+bool ofxSlitScanCore::admitsNextFrame(){
+	if(admission == ADMIT_FRAME_RATE){
+		//a quarter of a period early still counts, so jitter in the source doesn't skip frames
+		return now() >= nextAdmitTime - .25 / admissionAmount;
+	}
+	return admitCountdown == 0;
+}
+
+bool ofxSlitScanCore::offerFrame(){
+	if(!admitsNextFrame()){
+		admitCountdown = MAX(admitCountdown - 1, 0);
+		stats.framesSkipped++;
+		return false;
+	}
+	admittedAt = now();
+	if(admission == ADMIT_FRAME_RATE){
+		//a source slower than the rate has every frame stored
+		nextAdmitTime = MAX(nextAdmitTime + 1 / admissionAmount, admittedAt);
+	}
+	admitCountdown = admittedEvery - 1;
+	return true;
+}
+
+void ofxSlitScanCore::adaptAdmission(){
+	//what the frame took to store and the renders since the last one,
+	//which overlap when they run in the background. Smoothed so a single
+	//slow frame doesn't change much
+	double storeSeconds = now() - admittedAt;
+	double cost = asyncRendering ? MAX(storeSeconds, admissionRenderSeconds) : storeSeconds + admissionRenderSeconds;
+	admissionRenderSeconds = 0;
+	admissionCost = admissionCost == 0 ? cost : admissionCost * .75 + cost * .25;
+	
+	//store 1 in every so many frames for the cost to fit in the budget of the frames between
+	int needed = int(ceil(admissionCost / admissionAmount));
+	if(needed > admittedEvery){
+		admittedEvery = MIN(needed, ADMISSION_MAX_EVERY);
+	}
+	else if(admittedEvery > 1 && admissionCost < admissionAmount * (admittedEvery - 1) * .8){
+		admittedEvery--;
+	}
+}
+
+bool ofxSlitScanCore::isRetimed(){
+	return (admission == ADMIT_FRAME_RATE || admission == ADMIT_ADAPTIVE) && !sparseRetention;
+}
+
+float ofxSlitScanCore::retimedOffset(float offset){
+	//the stored frames span from the oldest to the newest time, evenly
+	//they would be this far apart
+	int stored = int(MIN((unsigned long long)capacity, framesAdded));
+	if(stored < 2){
+		return offset;
+	}
+	int oldest = capacity - stored;
+	double newestTime = slotTimes[frame_index(framepointer, capacity - 1, capacity)];
+	double oldestTime = slotTimes[frame_index(framepointer, oldest, capacity)];
+	double interval = (newestTime - oldestTime) / (stored - 1);
+	double time = newestTime - (capacity - 1 - offset) * interval;
+	if(interval <= 0 || time <= oldestTime){
+		return offset;
+	}
+	
+	//the pair of stored frames either side of that time, times go up with the offset
+	int low = oldest;
+	int high = capacity - 1;
+	while(high - low > 1){
+		int middle = (low + high) / 2;
+		if(slotTimes[frame_index(framepointer, middle, capacity)] <= time){
+			low = middle;
+		}
+		else{
+			high = middle;
+		}
+	}
+	double lowTime = slotTimes[frame_index(framepointer, low, capacity)];
+	double highTime = slotTimes[frame_index(framepointer, high, capacity)];
+	if(highTime <= lowTime){
+		return low;
+	}
+	return low + float(clamp(float((time - lowTime) / (highTime - lowTime)), 0, 1));
+}
+
+void ofxSlitScanCore::updateDelayLUT(){
+	levelLowerFrames.resize(delayMapLevelCount);
+	levelUpperFrames.resize(delayMapLevelCount);
+	levelLowerSlots.resize(delayMapLevelCount);
+	levelUpperSlots.resize(delayMapLevelCount);
+	updateLevelOffsets(delayMapLevelCount, timeDelay, timeWidth, levelLowerOffsets, levelUpperOffsets, levelWeights);
+	
+	delayLUTIsDirty = false;
+	bucketsAreDirty = true;
+	
+	//the capacity or the transfer curve may have changed too
+	for(size_t i = 0; i < namedOutputs.size(); i++){
+		namedOutputs[i].levelsAreDirty = true;
+	}
+	
+	if(isHistoryFileBacked()){
+		adviseHistoryWindow();
+	}
+}
+
+void ofxSlitScanCore::updateLevelOffsets(int levelCount, int _timeDelay, int _timeWidth,
+										 vector<int>& lowerOffsets, vector<int>& upperOffsets, vector<unsigned char>& weights){
+	int mapMin = capacity - _timeDelay - _timeWidth;// (time_delay + time_width);
+	int mapMax = capacity - 1 - _timeDelay;// - time_delay;
+	int mapRange = mapMax - mapMin;
+	
+	lowerOffsets.resize(levelCount);
+	upperOffsets.resize(levelCount);
+	weights.resize(levelCount);
+	
+	//uneven frames move the window along with the levels
+	bool retimed = isRetimed();
+	int upperLimit = MIN(retimed ? capacity - 1 : mapMax, capacity - 1);
+	
+	for(int level = 0; level < levelCount; level++){
+		float value = level / double(levelCount - 1);
+		if(transferCurve.size() > 1){
+			//linearly interpolate the curve
+			float curvePosition = value * (transferCurve.size() - 1);
+			int curveIndex = MIN(int(curvePosition), int(transferCurve.size()) - 2);
+			float curveAlpha = curvePosition - curveIndex;
+			value = clamp(transferCurve[curveIndex]*(1-curveAlpha) + transferCurve[curveIndex+1]*curveAlpha, 0, 1);
+		}
+		
+		//find pixel point in local reference
+		float precise = value * mapRange + mapMin;
+		if(retimed){
+			precise = retimedOffset(precise);
+		}
+		//cast it to an integer
+		int offset = int(precise);
+		float alpha = precise - offset;
+		
+		//a delay and width left over from a bigger capacity can reach outside the history
+		offset = clamp(offset, 0, capacity - 1);
+		
+		lowerOffsets[level] = offset;
+		upperOffsets[level] = MAX(offset, MIN(offset+1, upperLimit));
+		weights[level] = ofxSlitScanKernels::weightForAlpha(alpha);
+	}
+}
+
+bool ofxSlitScanCore::setHistoryDirectory(const string& directory){
+	waitForRender();
+	if(directory == historyDirectory){
+		return true;
+	}
+	
+	string previous = historyDirectory;
+	historyDirectory = directory;
+	
+	//the sparse history stays in memory, the ring is made in the new place when it comes back
+	if(!buffersAllocated || sparseRetention){
+		return true;
+	}
+	if(!moveHistory()){
+		log(LOG_ERROR, "ofxSlitScan -- Could not make a history file in %s", directory.c_str());
+		historyDirectory = previous;
+		return false;
+	}
+	adviseHistoryWindow();
+	return true;
+}
+
+string ofxSlitScanCore::getHistoryDirectory(){
+	return historyDirectory;
+}
+
+void ofxSlitScanCore::historyWindow(int& nearest, int& furthest){
+	//the ages any of the outputs read between
+	nearest = timeDelay;
+	furthest = timeDelay + timeWidth - 1;
+	for(size_t i = 0; i < namedOutputs.size(); i++){
+		nearest = MIN(nearest, namedOutputs[i].timeDelay);
+		furthest = MAX(furthest, namedOutputs[i].timeDelay + namedOutputs[i].timeWidth - 1);
+	}
+	nearest = MIN(nearest, capacity - 1);
+	furthest = MIN(furthest, capacity - 1);
+}
+
+void ofxSlitScanCore::adviseHistoryWindow(){
+	//frames are read between these ages, plus the few about to enter
+	int nearest, furthest;
+	historyWindow(nearest, furthest);
+	nearest = MAX(nearest - HISTORY_READAHEAD_FRAMES, 0);
+	for(int age = 0; age < capacity; age++){
+		int slot = frame_index(framepointer, capacity - 1 - age, capacity);
+		if(!frameWritten[slot]){
+			continue;
+		}
+		if(age >= nearest && age <= furthest){
+			slotCells[slot].block->prefetch(slotCells[slot].offset, bytesPerFrame);
+		}
+		else{
+			slotCells[slot].block->evict(slotCells[slot].offset, bytesPerFrame);
+		}
+	}
+}
+
+void ofxSlitScanCore::adviseNewFrame(int slot){
+	//frames are written once, in order, so push them out right away
+	if(frameWritten[slot] && adoptedFrames[slot] == NULL){
+		slotCells[slot].block->writeBack(slotCells[slot].offset, bytesPerFrame);
+	}
+	
+	int nearest, furthest;
+	historyWindow(nearest, furthest);
+	nearest -= HISTORY_READAHEAD_FRAMES;
+	
+	//the new frame won't be read for a while
+	if(nearest > 0 && frameWritten[slot]){
+		slotCells[slot].block->evict(slotCells[slot].offset, bytesPerFrame);
+	}
+	
+	//read in the frame that is about to enter the window
+	if(nearest > 0){
+		int enteringSlot = frame_index(framepointer, capacity - 1 - nearest, capacity);
+		if(frameWritten[enteringSlot]){
+			slotCells[enteringSlot].block->prefetch(slotCells[enteringSlot].offset, bytesPerFrame);
+		}
+	}
+	
+	//and let go of the one that just left it
+	if(furthest + 1 < capacity){
+		int leavingSlot = frame_index(framepointer, capacity - 1 - (furthest + 1), capacity);
+		if(frameWritten[leavingSlot]){
+			slotCells[leavingSlot].block->evict(slotCells[leavingSlot].offset, bytesPerFrame);
+		}
+	}
+}
+
+void ofxSlitScanCore::updateBuckets(){
+	storeProceduralMap();
+	
+	//counting sort of the pixels by the offset of the older frame they read
+	int n = outputWidth * outputHeight;
+	bucketStarts.assign(capacity + 1, 0);
+	for(int i = 0; i < n; i++){
+		bucketStarts[levelLowerOffsets[delayMapLevels[i]] + 1]++;
+	}
+	for(int offset = 0; offset < capacity; offset++){
+		bucketStarts[offset + 1] += bucketStarts[offset];
+	}
+	
+	vector<int> bucketFill(bucketStarts.begin(), bucketStarts.end() - 1);
+	bucketPixels.resize(n);
+	for(int i = 0; i < n; i++){
+		bucketPixels[bucketFill[levelLowerOffsets[delayMapLevels[i]]]++] = i;
+	}
+	
+	bucketsAreDirty = false;
+}
+
+const unsigned char* ofxSlitScanCore::getOutput(unsigned long long* version){
+	stats.outputRequests++;
+	if(!buffersAllocated){
+		if(version != NULL){
+			*version = outputVersion;
+		}
+		return outputBuffer;
+	}
+	takeQueuedFrames();
+	
+	if(asyncRendering){
+		//nothing new was committed but the settings changed
+		if(outputIsDirty){
+			startRender();
+		}
+		if(!asyncAllowsLatency){
+			waitForRender();
+		}
+		std::unique_lock<std::mutex> lock(renderMutex);
+		if(version != NULL){
+			*version = outputVersion;
+		}
+		return &frontPixels[0];
+	}
+	
+	if(outputIsDirty){
+		prepareRender();
+		renderOutput();
+		outputIsDirty = false;
+		outputVersion++;
+	}
+	if(version != NULL){
+		*version = outputVersion;
+	}
+	return outputBuffer;
+}
+
+void ofxSlitScanCore::prepareRender(){
+	renderStart = now();
+	if(delayLUTIsDirty){
+		updateDelayLUT();
+	}
+	
+	if(sparseRetention){
+		updateRetention();
+	}
+	else{
+		if(coldAge > 0){
+			collectColdFrames();
+		}
+		
+		//convert the level offsets to framepointer reference point
+		renderReadsColdFrames = false;
+		for(int level = 0; level < delayMapLevelCount; level++){
+			levelLowerSlots[level] = frame_index(framepointer, levelLowerOffsets[level], capacity);
+			levelUpperSlots[level] = frame_index(framepointer, levelUpperOffsets[level], capacity);
+			levelLowerFrames[level] = pixelsForSlot(levelLowerSlots[level]);
+			levelUpperFrames[level] = pixelsForSlot(levelUpperSlots[level]);
+			renderReadsColdFrames |= levelLowerFrames[level] == NULL || levelUpperFrames[level] == NULL;
+		}
+		for(size_t i = 0; i < namedOutputs.size(); i++){
+			resolveOutputFrames(namedOutputs[i]);
+		}
+		
+		if(bucketed && bucketsAreDirty && !outputIsResampled){
+			updateBuckets();
+		}
+	}
+}
+
+void ofxSlitScanCore::renderOutput(){
+	int n = outputWidth * outputHeight;
+	bool namedOutputsRendered = false;
+	if(sparseRetention){
+		//the retained history is already sorted by frame, render it in runs
+		int numRuns = (n + RENDER_BUCKET_PIXELS - 1) / RENDER_BUCKET_PIXELS;
+		threadPool.run(numRuns, [this, n](int run){
+			renderRetained(run * RENDER_BUCKET_PIXELS, MIN((run + 1) * RENDER_BUCKET_PIXELS, n));
+		});
+	}
+	else if(bucketed && !outputIsResampled){
+		//calculate the new distorted image, a run of frame sorted pixels per task
+		int numRuns = (n + RENDER_BUCKET_PIXELS - 1) / RENDER_BUCKET_PIXELS;
+		threadPool.run(numRuns, [this, n](int run){
+			renderBuckets(run * RENDER_BUCKET_PIXELS, MIN((run + 1) * RENDER_BUCKET_PIXELS, n));
+		});
+	}
+	else{
+		//calculate the new distorted image, one band of rows per task.
+		//named outputs render the same band straight after, while the
+		//rows of the frames they share are still in cache
+		bool withNamedOutputs = !outputIsResampled;
+		int numBands = (outputHeight + RENDER_BAND_ROWS - 1) / RENDER_BAND_ROWS;
+		threadPool.run(numBands, [this, withNamedOutputs](int band){
+			int startRow = band * RENDER_BAND_ROWS;
+			int endRow = MIN(startRow + RENDER_BAND_ROWS, outputHeight);
+			renderRows(startRow, endRow);
+			for(size_t i = 0; i < namedOutputs.size() && withNamedOutputs; i++){
+				renderOutputRows(namedOutputs[i], startRow, endRow);
+			}
+		});
+		namedOutputsRendered = withNamedOutputs;
+	}
+	
+	//otherwise they get a pass of their own
+	if(!namedOutputsRendered && !namedOutputs.empty()){
+		int numBands = (height + RENDER_BAND_ROWS - 1) / RENDER_BAND_ROWS;
+		threadPool.run(numBands, [this](int band){
+			int startRow = band * RENDER_BAND_ROWS;
+			for(size_t i = 0; i < namedOutputs.size(); i++){
+				renderOutputRows(namedOutputs[i], startRow, MIN(startRow + RENDER_BAND_ROWS, height));
+			}
+		});
+	}
+	
+	double seconds = now() - renderStart;
+	admissionRenderSeconds += seconds;
+	stats.renders++;
+	int samples = (blend ? 2 : 1) * (outputIsResampled && resampling == RESAMPLE_BILINEAR ? 4 : 1);
+	stats.bytesRead += (unsigned long long)outputBytes * samples;
+	stats.bytesWritten += outputBytes;
+	for(size_t i = 0; i < namedOutputs.size(); i++){
+		stats.bytesRead += (unsigned long long)bytesPerFrame * (namedOutputs[i].blend ? 2 : 1);
+		stats.bytesWritten += bytesPerFrame;
+	}
+	if(blend){
+		stats.blendRenders++;
+		stats.blendRenderSeconds += seconds;
+	}
+	else{
+		stats.renderSeconds += seconds;
+	}
+}
+
+void ofxSlitScanCore::setAsyncRendering(bool async, bool allowLatency){
+	waitForRender();
+	asyncAllowsLatency = allowLatency;
+	if(async == asyncRendering){
+		return;
+	}
+	
+	asyncRendering = async;
+	if(asyncRendering){
+		if(buffersAllocated){
+			frontPixels.assign(outputBytes, 0);
+			backPixels.assign(outputBytes, 0);
+			
+			//start out with what the caller sees now
+			memcpy(&frontPixels[0], outputBuffer, outputBytes);
+		}
+		for(size_t i = 0; i < namedOutputs.size(); i++){
+			namedOutputs[i].backPixels.assign(bytesPerFrame, 0);
+		}
+		renderStopping = false;
+		renderThread = std::thread(&ofxSlitScanCore::renderLoop, this);
+	}
+	else{
+		stopRenderThread();
+		vector<unsigned char>().swap(frontPixels);
+		vector<unsigned char>().swap(backPixels);
+		for(size_t i = 0; i < namedOutputs.size(); i++){
+			vector<unsigned char>().swap(namedOutputs[i].backPixels);
+		}
+		if(buffersAllocated){
+			outputBuffer = callerBuffer == NULL ? &outputPixels[0] : callerBuffer;
+		}
+	}
+	outputIsDirty = true;
+}
+
+bool ofxSlitScanCore::isAsyncRendering(){
+	return asyncRendering;
+}
+
+unsigned long long ofxSlitScanCore::getOutputVersion(){
+	std::unique_lock<std::mutex> lock(renderMutex);
+	return outputVersion;
+}
+
+void ofxSlitScanCore::renderLoop(){
+	std::unique_lock<std::mutex> lock(renderMutex);
+	while(true){
+		while(!renderRunning && !renderStopping){
+			renderCondition.wait(lock);
+		}
+		if(renderStopping){
+			return;
+		}
+		lock.unlock();
+		
+		outputBuffer = &backPixels[0];
+		renderOutput();
+		
+		lock.lock();
+		frontPixels.swap(backPixels);
+		for(size_t i = 0; i < namedOutputs.size(); i++){
+			namedOutputs[i].pixels.swap(namedOutputs[i].backPixels);
+		}
+		outputVersion++;
+		renderRunning = false;
+		renderCondition.notify_all();
+	}
+}
+
+void ofxSlitScanCore::startRender(){
+	//everything that touches the history's bookkeeping happens here,
+	//the render thread only reads the resolved frames
+	prepareRender();
+	
+	//the next frame goes into the oldest slot, remember if this render reads it.
+	//procedural maps aren't counted up, any level they can reach counts
+	int lowestLevel = 0;
+	int highestLevel = delayMapLevelCount - 1;
+	if(mapIsProcedural){
+		proceduralLevelRange(lowestLevel, highestLevel);
+	}
+	else{
+		updateLevelPixelCounts();
+	}
+	renderReadsOldest = sparseRetention;
+	for(int level = lowestLevel; level <= highestLevel && !renderReadsOldest; level++){
+		renderReadsOldest = (mapIsProcedural || levelPixelCounts[level] > 0) &&
+			(levelLowerOffsets[level] == 0 || (blend && levelUpperOffsets[level] == 0));
+	}
+	for(size_t i = 0; i < namedOutputs.size(); i++){
+		renderReadsOldest |= namedOutputs[i].readsOldest;
+	}
+	
+	//settings are taken as they are now, later changes wait for this render
+	outputIsDirty = false;
+	std::unique_lock<std::mutex> lock(renderMutex);
+	renderRunning = true;
+	renderCondition.notify_all();
+}
+
+void ofxSlitScanCore::waitForRender(){
+	if(!asyncRendering){
+		return;
+	}
+	std::unique_lock<std::mutex> lock(renderMutex);
+	while(renderRunning){
+		renderCondition.wait(lock);
+	}
+}
+
+void ofxSlitScanCore::stopRenderThread(){
+	if(!renderThread.joinable()){
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock(renderMutex);
+		while(renderRunning){
+			renderCondition.wait(lock);
+		}
+		renderStopping = true;
+		renderCondition.notify_all();
+	}
+	renderThread.join();
+}
+
+bool ofxSlitScanCore::isOutputDirty(){
+	return outputIsDirty;
+}
+
+void ofxSlitScanCore::setOutputBuffer(unsigned char* pixels){
+	if(!buffersAllocated){
+		return;
+	}
+	
+	//the caller's buffer starts out with whatever it had, so render it again
+	waitForRender();
+	callerBuffer = pixels;
+	if(!asyncRendering){
+		outputBuffer = callerBuffer == NULL ? &outputPixels[0] : callerBuffer;
+	}
+	outputIsDirty = true;
+}
+
+void ofxSlitScanCore::copyOutput(unsigned char* pixels, size_t stride){
+	int rowBytes = outputWidth * bytesPerPixel;
+	const unsigned char* output = getOutput();
+	copyRows(pixels, stride == 0 ? rowBytes : stride, output, rowBytes, rowBytes, outputHeight);
+}
+
+bool ofxSlitScanCore::renderRegion(int x, int y, int w, int h, unsigned char* pixels, size_t stride){
+	if(!buffersAllocated){
+		return false;
+	}
+	if(x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > outputWidth || y + h > outputHeight){
+		log(LOG_ERROR, "ofxSlitScan -- region %dx%d at %d,%d is outside the %dx%d output", w, h, x, y, outputWidth, outputHeight);
+		return false;
+	}
+	int rowBytes = w * bytesPerPixel;
+	if(stride == 0){
+		stride = rowBytes;
+	}
+	
+	//already up to date from the last time
+	for(size_t i = 0; i < renderedRegions.size(); i++){
+		RenderedRegion& region = renderedRegions[i];
+		if(region.x == x && region.y == y && region.w == w && region.h == h && region.pixels == pixels && region.stride == stride){
+			if(region.version == changeVersion){
+				return true;
+			}
+			renderedRegions.erase(renderedRegions.begin() + i);
+			break;
+		}
+	}
+	
+	waitForRender();
+	double start = now();
+	if(sparseRetention){
+		//retained pixels are grouped by map value, not position, so crop a full render
+		getOutput();
+		waitForRender();
+		const unsigned char* output = asyncRendering ? &frontPixels[0] : outputBuffer;
+		int outputRowBytes = outputWidth * bytesPerPixel;
+		copyRows(pixels, stride, output + y * outputRowBytes + x * bytesPerPixel, outputRowBytes, rowBytes, h);
+	}
+	else{
+		prepareRender();
+		int numBands = (h + RENDER_BAND_ROWS - 1) / RENDER_BAND_ROWS;
+		threadPool.run(numBands, [this, x, y, w, h, pixels, stride](int band){
+			int startRow = band * RENDER_BAND_ROWS;
+			renderRect(x, x + w, y + startRow, y + MIN(startRow + RENDER_BAND_ROWS, h), pixels + startRow * stride, stride);
+		});
+	}
+	
+	stats.regionRenders++;
+	stats.regionPixels += (unsigned long long)w * h;
+	stats.regionSeconds += now() - start;
+	
+	if(renderedRegions.size() == RENDER_REGION_CACHE){
+		renderedRegions.erase(renderedRegions.begin());
+	}
+	RenderedRegion region = {x, y, w, h, pixels, stride, changeVersion};
+	renderedRegions.push_back(region);
+	return true;
+}
+
+bool ofxSlitScanCore::addOutput(const string& name){
+	waitForRender();
+	if(!buffersAllocated){
+		return false;
+	}
+	if(sparseRetention){
+		log(LOG_ERROR, "ofxSlitScan -- Named outputs can't be added with sparse retention on");
+		return false;
+	}
+	if(findOutput(name) != NULL){
+		log(LOG_ERROR, "ofxSlitScan -- There is already an output named %s", name.c_str());
+		return false;
+	}
+	
+	//starts out like the main output after setup
+	NamedOutput output;
+	output.name = name;
+	output.levels.assign(width * height, 0);
+	output.levelCount = 256;
+	output.timeDelay = 0;
+	output.timeWidth = capacity;
+	output.blend = false;
+	output.levelsAreDirty = true;
+	output.readsOldest = true;
+	output.readsColdFrames = false;
+	output.pixels.assign(bytesPerFrame, 0);
+	if(asyncRendering){
+		output.backPixels.assign(bytesPerFrame, 0);
+	}
+	namedOutputs.push_back(output);
+	markOutputDirty();
+	return true;
+}
+
+void ofxSlitScanCore::removeOutput(const string& name){
+	waitForRender();
+	for(size_t i = 0; i < namedOutputs.size(); i++){
+		if(namedOutputs[i].name == name){
+			namedOutputs.erase(namedOutputs.begin() + i);
+			return;
+		}
+	}
+}
+
+bool ofxSlitScanCore::hasOutput(const string& name){
+	return findOutput(name) != NULL;
+}
+
+vector<string> ofxSlitScanCore::getOutputNames(){
+	vector<string> names;
+	for(size_t i = 0; i < namedOutputs.size(); i++){
+		names.push_back(namedOutputs[i].name);
+	}
+	return names;
+}
+
+void ofxSlitScanCore::setOutputDelayMap(const string& name, const unsigned char* map, int w, int h, int channels, size_t stride){
+	waitForRender();
+	NamedOutput* output = findOutput(name);
+	if(output == NULL || w <= 0 || h <= 0){
+		log(LOG_ERROR, "ofxSlitScan -- Can't set a %dx%d map on output %s", w, h, name.c_str());
+		return;
+	}
+	vector<unsigned short> levels;
+	if(!quantizeMap(map, w, h, channels, stride, levels, output->levelCount)){
+		return;
+	}
+	resampleLevels(&levels[0], w, h, &output->levels[0], width, height, true);
+	output->levelsAreDirty = true;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::setOutputDelayMap(const string& name, const float* map, int w, int h, size_t stride){
+	waitForRender();
+	NamedOutput* output = findOutput(name);
+	if(output == NULL || w <= 0 || h <= 0){
+		log(LOG_ERROR, "ofxSlitScan -- Can't set a %dx%d map on output %s", w, h, name.c_str());
+		return;
+	}
+	vector<unsigned short> levels;
+	quantizeMap(map, w, h, stride, levels, output->levelCount);
+	resampleLevels(&levels[0], w, h, &output->levels[0], width, height, true);
+	output->levelsAreDirty = true;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::setOutputTimeDelayAndWidth(const string& name, int _timeDelay, int _timeWidth){
+	waitForRender();
+	NamedOutput* output = findOutput(name);
+	if(output == NULL){
+		return;
+	}
+	output->timeDelay = clamp(_timeDelay, 0, capacity-1);
+	output->timeWidth = clamp(_timeWidth, 1, capacity);
+	if(output->timeDelay + output->timeWidth > capacity){
+		log(LOG_ERROR, "ofxSlitScan -- Invalid time delay and width specified, adds to %d with a capacity of %d", (output->timeDelay+output->timeWidth), capacity);
+		output->timeDelay = 0;
+		output->timeWidth = capacity;
+	}
+	output->levelsAreDirty = true;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::setOutputBlending(const string& name, bool _blend){
+	waitForRender();
+	NamedOutput* output = findOutput(name);
+	if(output == NULL){
+		return;
+	}
+	output->blend = _blend;
+	output->levelsAreDirty = true;
+	markOutputDirty();
+}
+
+const unsigned char* ofxSlitScanCore::getOutput(const string& name, unsigned long long* version){
+	NamedOutput* output = findOutput(name);
+	if(output == NULL){
+		log(LOG_ERROR, "ofxSlitScan -- There is no output named %s", name.c_str());
+		return NULL;
+	}
+	
+	//named outputs are rendered along with the main one
+	getOutput();
+	std::unique_lock<std::mutex> lock(renderMutex);
+	if(version != NULL){
+		*version = outputVersion;
+	}
+	return &output->pixels[0];
+}
+
+ofxSlitScanCore::NamedOutput* ofxSlitScanCore::findOutput(const string& name){
+	for(size_t i = 0; i < namedOutputs.size(); i++){
+		if(namedOutputs[i].name == name){
+			return &namedOutputs[i];
+		}
+	}
+	return NULL;
+}
+
+void ofxSlitScanCore::updateOutputLevels(NamedOutput& output){
+	updateLevelOffsets(output.levelCount, output.timeDelay, output.timeWidth, output.lowerOffsets, output.upperOffsets, output.weights);
+	output.lowerFrames.resize(output.levelCount);
+	output.upperFrames.resize(output.levelCount);
+	output.lowerSlots.resize(output.levelCount);
+	output.upperSlots.resize(output.levelCount);
+	
+	//see if the next frame has to wait for an asynchronous render of this output
+	vector<bool> used(output.levelCount, false);
+	for(size_t i = 0; i < output.levels.size(); i++){
+		used[output.levels[i]] = true;
+	}
+	output.readsOldest = false;
+	for(int level = 0; level < output.levelCount && !output.readsOldest; level++){
+		output.readsOldest = used[level] && (output.lowerOffsets[level] == 0 || (output.blend && output.upperOffsets[level] == 0));
+	}
+	output.levelsAreDirty = false;
+	
+	if(isHistoryFileBacked()){
+		adviseHistoryWindow();
+	}
+}
+
+void ofxSlitScanCore::resolveOutputFrames(NamedOutput& output){
+	if(output.levelsAreDirty){
+		updateOutputLevels(output);
+	}
+	output.readsColdFrames = false;
+	for(int level = 0; level < output.levelCount; level++){
+		output.lowerSlots[level] = frame_index(framepointer, output.lowerOffsets[level], capacity);
+		output.upperSlots[level] = frame_index(framepointer, output.upperOffsets[level], capacity);
+		output.lowerFrames[level] = pixelsForSlot(output.lowerSlots[level]);
+		output.upperFrames[level] = pixelsForSlot(output.upperSlots[level]);
+		output.readsColdFrames |= output.lowerFrames[level] == NULL || output.upperFrames[level] == NULL;
+	}
+}
+
+void ofxSlitScanCore::renderOutputRows(NamedOutput& output, int startRow, int endRow){
+	int rowBytes = width * bytesPerPixel;
+	unsigned char* pixels = asyncRendering ? &output.backPixels[0] : &output.pixels[0];
+	LevelTable table = {&output.levels[0], &output.weights[0], &output.lowerFrames[0], &output.upperFrames[0],
+		&output.lowerSlots[0], &output.upperSlots[0], output.blend, output.readsColdFrames, false};
+	renderLevels(table, 0, width, startRow, endRow, pixels + startRow * rowBytes, rowBytes);
+}
+
+void ofxSlitScanCore::markOutputDirty(){
+	outputIsDirty = true;
+	changeVersion++;
+}
+
+void ofxSlitScanCore::renderRows(int startRow, int endRow){
+	int rowBytes = outputWidth * bytesPerPixel;
+	renderRect(0, outputWidth, startRow, endRow, outputBuffer + startRow * rowBytes, rowBytes);
+}
+
+void ofxSlitScanCore::renderRect(int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride){
+	if(outputIsResampled){
+		switch(bytesPerPixel){
+			case 1:{
+				renderResampledRect<1>(left, right, startRow, endRow, pixels, stride);
+			}break;
+			case 3:{
+				renderResampledRect<3>(left, right, startRow, endRow, pixels, stride);
+			}break;
+			case 4:{
+				renderResampledRect<4>(left, right, startRow, endRow, pixels, stride);
+			}break;
+		}
+		return;
+	}
+	
+	LevelTable table = {delayMapLevels, &levelWeights[0], &levelLowerFrames[0], &levelUpperFrames[0],
+		&levelLowerSlots[0], &levelUpperSlots[0], blend, renderReadsColdFrames, mapIsProcedural};
+	renderLevels(table, left, right, startRow, endRow, pixels, stride);
+}
+
+void ofxSlitScanCore::renderLevels(const LevelTable& table, int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride){
+	//specialize the inner loops on the channel count
+	switch(bytesPerPixel){
+		case 1:{
+			if(table.cold){
+				renderRectWithChannels<1, true>(table, left, right, startRow, endRow, pixels, stride);
+			}
+			else{
+				renderRectWithChannels<1, false>(table, left, right, startRow, endRow, pixels, stride);
+			}
+		}break;
+		case 3:{
+			if(table.cold){
+				renderRectWithChannels<3, true>(table, left, right, startRow, endRow, pixels, stride);
+			}
+			else{
+				renderRectWithChannels<3, false>(table, left, right, startRow, endRow, pixels, stride);
+			}
+		}break;
+		case 4:{
+			if(table.cold){
+				renderRectWithChannels<4, true>(table, left, right, startRow, endRow, pixels, stride);
+			}
+			else{
+				renderRectWithChannels<4, false>(table, left, right, startRow, endRow, pixels, stride);
+			}
+		}break;
+	}
+}
+
+template<int channels, bool cold>
+void ofxSlitScanCore::renderRectWithChannels(const LevelTable& table, int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride){
+	ColdFrameReader coldReader(coldFrames, cold ? capacity : 0);
+	int rectWidth = right - left;
+	int rowBytes = rectWidth * channels;
+	
+	//procedural maps are evaluated a row at a time into levelRow
+	vector<unsigned short> levelRow(table.procedural ? rectWidth : 0);
+	
+	if(table.blend){
+		//gather both frames and the weights a row at a time, then blend the row in one go
+		ofxSlitScanKernels::BlendFunction blendRow = ofxSlitScanKernels::getBlendFunction();
+		vector<unsigned char> scratch(rowBytes * 3);
+		unsigned char* lowerRow = &scratch[0];
+		unsigned char* upperRow = lowerRow + rowBytes;
+		unsigned char* weightRow = upperRow + rowBytes;
+		
+		for(int row = startRow; row < endRow; row++){
+			int rowStart = row * width + left;
+			int pixelIndex = rowStart * channels;
+			int rowIndex = 0;
+			const unsigned short* levels = table.levels + rowStart;
+			if(table.procedural){
+				proceduralRow(row, left, right, &levelRow[0]);
+				levels = &levelRow[0];
+			}
+			for(int x = 0; x < rectWidth; x++) {
+				int level = levels[x];
+				unsigned char weight = table.weights[level];
+				
+				//get buffers
+				unsigned char *a = framePixel<cold>(table.lowerFrames[level], table.lowerSlots[level], pixelIndex, coldReader);
+				unsigned char *b = framePixel<cold>(table.upperFrames[level], table.upperSlots[level], pixelIndex, coldReader);
+				
+				for(int c = 0; c < channels; c++) {
+					lowerRow[rowIndex + c] = a[c];
+					upperRow[rowIndex + c] = b[c];
+					weightRow[rowIndex + c] = weight;
+				}
+				rowIndex += channels;
+				pixelIndex += channels;
+			}
+			
+			//interpolate and set values
+			blendRow(pixels, lowerRow, upperRow, weightRow, rowBytes);
+			pixels += stride;
+		}
+	}
+	else{
+		for(int row = startRow; row < endRow; row++){
+			int rowStart = row * width + left;
+			int pixelIndex = rowStart * channels;
+			unsigned char* outbuffer = pixels;
+			const unsigned short* levels = table.levels + rowStart;
+			if(table.procedural){
+				proceduralRow(row, left, right, &levelRow[0]);
+				levels = &levelRow[0];
+			}
+			for(int x = 0; x < rectWidth; x++) {
+				int level = levels[x];
+				unsigned char *a = framePixel<cold>(table.lowerFrames[level], table.lowerSlots[level], pixelIndex, coldReader);
+				// faster than memcpy because the compiler can optimize it
+				for(int c = 0; c < channels; c++) {
+					*outbuffer++ = a[c];
+				}
+				pixelIndex += channels;
+			}
+			pixels += stride;
+		}
+	}
+}
+
+template<int channels>
+void ofxSlitScanCore::renderResampledRect(int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride){
+	bool bilinear = resampling == RESAMPLE_BILINEAR;
+	if(renderReadsColdFrames){
+		if(bilinear){
+			renderResampledRectWithChannels<channels, true, true>(left, right, startRow, endRow, pixels, stride);
+		}
+		else{
+			renderResampledRectWithChannels<channels, true, false>(left, right, startRow, endRow, pixels, stride);
+		}
+	}
+	else{
+		if(bilinear){
+			renderResampledRectWithChannels<channels, false, true>(left, right, startRow, endRow, pixels, stride);
+		}
+		else{
+			renderResampledRectWithChannels<channels, false, false>(left, right, startRow, endRow, pixels, stride);
+		}
+	}
+}
+
+template<int channels, bool cold, bool bilinear>
+void ofxSlitScanCore::renderResampledRectWithChannels(int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride){
+	ColdFrameReader coldReader(coldFrames, cold ? capacity : 0);
+	int rowBytes = (right - left) * channels;
+	
+	//same as renderRectWithChannels, but every frame pixel is sampled at the
+	//position the output pixel falls on in the history
+	ofxSlitScanKernels::BlendFunction blendRow = ofxSlitScanKernels::getBlendFunction();
+	vector<unsigned char> scratch(blend ? rowBytes * 3 : 0);
+	vector<unsigned short> levelRow(mapIsProcedural ? right - left : 0);
+	for(int row = startRow; row < endRow; row++){
+		int top = resampleTop[row];
+		int bottom = resampleBottom[row];
+		unsigned int fy = resampleRowWeights[row];
+		const unsigned short* levels = delayMapLevels + row * outputWidth + left;
+		if(mapIsProcedural){
+			proceduralRow(row, left, right, &levelRow[0]);
+			levels = &levelRow[0];
+		}
+		
+		if(blend){
+			unsigned char* lowerRow = &scratch[0];
+			unsigned char* upperRow = lowerRow + rowBytes;
+			unsigned char* weightRow = upperRow + rowBytes;
+			int rowIndex = 0;
+			for(int x = left; x < right; x++){
+				int level = levels[x - left];
+				resamplePixel<channels, cold, bilinear>(levelLowerFrames[level], levelLowerSlots[level], top, bottom,
+														resampleLeft[x], resampleRight[x], resampleColumnWeights[x], fy, coldReader, lowerRow + rowIndex);
+				resamplePixel<channels, cold, bilinear>(levelUpperFrames[level], levelUpperSlots[level], top, bottom,
+														resampleLeft[x], resampleRight[x], resampleColumnWeights[x], fy, coldReader, upperRow + rowIndex);
+				for(int c = 0; c < channels; c++) {
+					weightRow[rowIndex + c] = levelWeights[level];
+				}
+				rowIndex += channels;
+			}
+			blendRow(pixels, lowerRow, upperRow, weightRow, rowBytes);
+		}
+		else{
+			unsigned char* outbuffer = pixels;
+			for(int x = left; x < right; x++){
+				int level = levels[x - left];
+				resamplePixel<channels, cold, bilinear>(levelLowerFrames[level], levelLowerSlots[level], top, bottom,
+														resampleLeft[x], resampleRight[x], resampleColumnWeights[x], fy, coldReader, outbuffer);
+				outbuffer += channels;
+			}
+		}
+		pixels += stride;
+	}
+}
+
+void ofxSlitScanCore::renderBuckets(int first, int last){
+	switch(bytesPerPixel){
+		case 1:{
+			if(renderReadsColdFrames){
+				renderBucketsWithChannels<1, true>(first, last);
+			}
+			else{
+				renderBucketsWithChannels<1, false>(first, last);
+			}
+		}break;
+		case 3:{
+			if(renderReadsColdFrames){
+				renderBucketsWithChannels<3, true>(first, last);
+			}
+			else{
+				renderBucketsWithChannels<3, false>(first, last);
+			}
+		}break;
+		case 4:{
+			if(renderReadsColdFrames){
+				renderBucketsWithChannels<4, true>(first, last);
+			}
+			else{
+				renderBucketsWithChannels<4, false>(first, last);
+			}
+		}break;
+	}
+}
+
+template<int channels, bool cold>
+void ofxSlitScanCore::renderBucketsWithChannels(int first, int last){
+	ColdFrameReader coldReader(coldFrames, cold ? capacity : 0);
+	unsigned char* outbuffer = outputBuffer;
+	
+	if(blend){
+		//gather in frame order, blend the run, then scatter it to the output
+		ofxSlitScanKernels::BlendFunction blendRun = ofxSlitScanKernels::getBlendFunction();
+		int runBytes = (last - first) * channels;
+		vector<unsigned char> scratch(runBytes * 4);
+		unsigned char* lowerRun = &scratch[0];
+		unsigned char* upperRun = lowerRun + runBytes;
+		unsigned char* weightRun = upperRun + runBytes;
+		unsigned char* blendedRun = weightRun + runBytes;
+		
+		int runIndex = 0;
+		for(int k = first; k < last; k++){
+			unsigned int i = bucketPixels[k];
+			int level = delayMapLevels[i];
+			unsigned char weight = levelWeights[level];
+			unsigned char *a = framePixel<cold>(levelLowerFrames[level], levelLowerSlots[level], i * channels, coldReader);
+			unsigned char *b = framePixel<cold>(levelUpperFrames[level], levelUpperSlots[level], i * channels, coldReader);
+			for(int c = 0; c < channels; c++) {
+				lowerRun[runIndex + c] = a[c];
+				upperRun[runIndex + c] = b[c];
+				weightRun[runIndex + c] = weight;
+			}
+			runIndex += channels;
+		}
+		
+		blendRun(blendedRun, lowerRun, upperRun, weightRun, runBytes);
+		
+		runIndex = 0;
+		for(int k = first; k < last; k++){
+			unsigned char *out = outbuffer + bucketPixels[k] * channels;
+			for(int c = 0; c < channels; c++) {
+				out[c] = blendedRun[runIndex + c];
+			}
+			runIndex += channels;
+		}
+	}
+	else{
+		for(int k = first; k < last; k++){
+			unsigned int i = bucketPixels[k];
+			int level = delayMapLevels[i];
+			unsigned char *a = framePixel<cold>(levelLowerFrames[level], levelLowerSlots[level], i * channels, coldReader);
+			unsigned char *out = outbuffer + i * channels;
+			for(int c = 0; c < channels; c++) {
+				out[c] = a[c];
+			}
+		}
+	}
+}
+
+void ofxSlitScanCore::setSparseRetention(bool sparse){
+	waitForRender();
+	if(sparse == sparseRetention || !buffersAllocated){
+		return;
+	}
+	if(sparse && outputIsResampled){
+		log(LOG_ERROR, "ofxSlitScan -- Sparse retention needs the output to be the size of the history");
+		return;
+	}
+	if(sparse && !namedOutputs.empty()){
+		log(LOG_ERROR, "ofxSlitScan -- Sparse retention only keeps what the main delay map reads, remove the named outputs first");
+		return;
+	}
+	
+	if(sparse){
+		//build the delay lines out of the full history, then let it go
+		setColdCompression(0);
+		sparseRetention = true;
+		retainedStarts.clear();
+		retainedStaging.resize(bytesPerFrame);
+		bucketsAreDirty = true;
+		updateRetention();
+		
+		releaseAllSlots();
+		releaseHistory();
+		frameWritten.assign(capacity, false);
+		historyGeneration++;
+	}
+	else{
+		//put every frame back together, pixels that weren't kept stay black
+		if(!reserveHistory()){
+			log(LOG_ERROR, "ofxSlitScan -- Could not reserve %d frames of %d bytes", capacity, bytesPerFrame);
+			return;
+		}
+		arenaFrameIds.assign(capacity, 0);
+		updateRetention();
+		int frameCount = MIN((unsigned long long)capacity, framesAdded);
+		for(int age = 0; age < frameCount; age++){
+			int slot = frame_index(framepointer, capacity - 1 - age, capacity);
+			slotCells[slot].block->commit(slotCells[slot].offset, bytesPerFrame);
+			frameWritten[slot] = true;
+			arenaFrameIds[slot] = slotFrameIds[slot] = framesAdded - age;
+			copyRetainedFrame(age, cellPixels(slot));
+		}
+		
+		sparseRetention = false;
+		historyGeneration++;
+		retainedFrames.release();
+		retainedStarts.clear();
+		vector<unsigned char>().swap(retainedStaging);
+	}
+	markOutputDirty();
+}
+
+bool ofxSlitScanCore::isSparseRetention(){
+	return sparseRetention;
+}
+
+const ofxSlitScanCore::Stats& ofxSlitScanCore::getStats(){
+	waitForRender();
+	stats.framesDropped += ingestQueue.takeDropped();
+	if(!buffersAllocated){
+		return stats;
+	}
+	if(delayLUTIsDirty){
+		updateDelayLUT();
+	}
+	
+	updateLevelPixelCounts();
+	
+	stats.ageHistogram.assign(capacity, 0);
+	for(int level = 0; level < delayMapLevelCount; level++){
+		if(levelPixelCounts[level] == 0){
+			continue;
+		}
+		stats.ageHistogram[capacity - 1 - levelLowerOffsets[level]] += levelPixelCounts[level];
+		if(blend && levelWeights[level] > 0 && levelUpperOffsets[level] != levelLowerOffsets[level]){
+			stats.ageHistogram[capacity - 1 - levelUpperOffsets[level]] += levelPixelCounts[level];
+		}
+	}
+	stats.framesTouched = 0;
+	for(int age = 0; age < capacity; age++){
+		if(stats.ageHistogram[age] > 0){
+			stats.framesTouched++;
+		}
+	}
+	return stats;
+}
+
+void ofxSlitScanCore::updateLevelPixelCounts(){
+	//pixels per map level only change with the map
+	if(levelPixelCountsAreDirty){
+		storeProceduralMap();
+		levelPixelCounts.assign(delayMapLevelCount, 0);
+		for(int i = 0; i < outputWidth * outputHeight; i++){
+			levelPixelCounts[delayMapLevels[i]]++;
+		}
+		levelPixelCountsAreDirty = false;
+	}
+}
+
+void ofxSlitScanCore::resetStats(){
+	waitForRender();
+	stats = Stats();
+	ingestQueue.takeDropped();
+}
+
+size_t ofxSlitScanCore::getHistoryBytes(){
+	waitForRender();
+	if(sparseRetention){
+		return retainedFrames.getSize();
+	}
+	if(coldAge == 0){
+		return capacity * frameStride;
+	}
+	
+	//cold frames hand their pages back, so count what is still resident
+	collectColdFrames();
+	size_t bytes = coldFrames.getCompressedBytes();
+	for(int slot = 0; slot < capacity; slot++){
+		if(frameWritten[slot]){
+			bytes += frameStride;
+		}
+	}
+	return bytes;
+}
+
+void ofxSlitScanCore::updateRetention(){
+	if(delayLUTIsDirty){
+		updateDelayLUT();
+	}
+	if(!bucketsAreDirty){
+		return;
+	}
+	updateBuckets();
+	
+	int n = width * height;
+	
+	//where each pixel sits in the current delay lines, if there are any
+	bool fromRetained = !retainedStarts.empty();
+	vector<int> oldGroups, oldIndices;
+	if(fromRetained){
+		oldGroups.resize(n);
+		oldIndices.resize(n);
+		for(size_t group = 0; group + 1 < retainedStarts.size(); group++){
+			for(int k = retainedStarts[group]; k < retainedStarts[group+1]; k++){
+				oldGroups[retainedPixels[k]] = group;
+				oldIndices[retainedPixels[k]] = k - retainedStarts[group];
+			}
+		}
+	}
+	
+	//every frame offset gets a line as deep as its age
+	vector<int> lengths(capacity);
+	vector<size_t> offsets(capacity);
+	size_t total = 0;
+	for(int offset = 0; offset < capacity; offset++){
+		int count = bucketStarts[offset+1] - bucketStarts[offset];
+		lengths[offset] = capacity - offset;
+		offsets[offset] = total;
+		total += (size_t)lengths[offset] * count * bytesPerPixel;
+	}
+	
+	ofxSlitScanArena resized;
+	if(!resized.allocate(total)){
+		log(LOG_ERROR, "ofxSlitScan -- Could not reserve %d bytes of sparse history", int(total));
+		return;
+	}
+	resized.commit(0, total);
+	
+	//carry over every age both the old and the new history keep
+	for(int offset = 0; offset < capacity; offset++){
+		int start = bucketStarts[offset];
+		int count = bucketStarts[offset+1] - start;
+		size_t runBytes = (size_t)count * bytesPerPixel;
+		for(int k = 0; k < count; k++){
+			int pixel = bucketPixels[start + k];
+			int keep = MIN((unsigned long long)lengths[offset], framesAdded);
+			if(fromRetained){
+				keep = MIN(keep, retainedLengths[oldGroups[pixel]]);
+			}
+			else{
+				keep = MIN(keep, capacity);
+			}
+			
+			for(int age = 0; age < keep; age++){
+				unsigned char* src;
+				if(fromRetained){
+					src = retainedRunForAge(oldGroups[pixel], age) + oldIndices[pixel] * bytesPerPixel;
+				}
+				else{
+					src = pixelsForSlot(frame_index(framepointer, capacity - 1 - age, capacity)) + pixel * bytesPerPixel;
+				}
+				unsigned char* dst = resized.getData() + offsets[offset] + ((framesAdded - 1 - age) % lengths[offset]) * runBytes + k * bytesPerPixel;
+				memcpy(dst, src, bytesPerPixel);
+			}
+		}
+	}
+	
+	retainedFrames.swap(resized);
+	retainedStarts = bucketStarts;
+	retainedLengths = lengths;
+	retainedOffsets = offsets;
+	retainedPixels = bucketPixels;
+}
+
+void ofxSlitScanCore::writeRetainedFrame(unsigned char* image){
+	updateRetention();
+	
+	//every line drops its oldest run for the new frame
+	for(size_t group = 0; group < retainedLengths.size(); group++){
+		int start = retainedStarts[group];
+		int count = retainedStarts[group+1] - start;
+		unsigned char* run = retainedFrames.getData() + retainedOffsets[group] + (framesAdded % retainedLengths[group]) * count * bytesPerPixel;
+		for(int k = start; k < start + count; k++){
+			memcpy(run, image + retainedPixels[k] * bytesPerPixel, bytesPerPixel);
+			run += bytesPerPixel;
+		}
+	}
+}
+
+void ofxSlitScanCore::copyRetainedFrame(int age, unsigned char* outbuf){
+	memset(outbuf, 0, bytesPerFrame);
+	for(size_t group = 0; group < retainedLengths.size(); group++){
+		if(retainedLengths[group] <= age){
+			continue;
+		}
+		unsigned char* run = retainedRunForAge(group, age);
+		for(int k = retainedStarts[group]; k < retainedStarts[group+1]; k++){
+			memcpy(outbuf + retainedPixels[k] * bytesPerPixel, run, bytesPerPixel);
+			run += bytesPerPixel;
+		}
+	}
+}
+
+unsigned char* ofxSlitScanCore::retainedRunForAge(int group, int age){
+	if(age < 0 || age >= retainedLengths[group] || (unsigned long long)age >= framesAdded){
+		return emptyFrame.getData();
+	}
+	int count = retainedStarts[group+1] - retainedStarts[group];
+	return retainedFrames.getData() + retainedOffsets[group] + ((framesAdded - 1 - age) % retainedLengths[group]) * count * bytesPerPixel;
+}
+
+void ofxSlitScanCore::renderRetained(int first, int last){
+	switch(bytesPerPixel){
+		case 1:{
+			renderRetainedWithChannels<1>(first, last);
+		}break;
+		case 3:{
+			renderRetainedWithChannels<3>(first, last);
+		}break;
+		case 4:{
+			renderRetainedWithChannels<4>(first, last);
+		}break;
+	}
+}
+
+template<int channels>
+void ofxSlitScanCore::renderRetainedWithChannels(int first, int last){
+	unsigned char* outbuffer = outputBuffer;
+	
+	int runBytes = (last - first) * channels;
+	vector<unsigned char> scratch(blend ? runBytes * 4 : 0);
+	unsigned char* lowerRun = blend ? &scratch[0] : NULL;
+	unsigned char* upperRun = lowerRun + runBytes;
+	unsigned char* weightRun = upperRun + runBytes;
+	unsigned char* blendedRun = weightRun + runBytes;
+	int runIndex = 0;
+	
+	//every pixel of a group reads the same two runs of its delay line
+	int group = int(upper_bound(retainedStarts.begin(), retainedStarts.end(), first) - retainedStarts.begin()) - 1;
+	for(int k = first; k < last; group++){
+		int groupStart = retainedStarts[group];
+		int groupEnd = MIN(retainedStarts[group+1], last);
+		int age = retainedLengths[group] - 1;
+		unsigned char* a = retainedRunForAge(group, age) + (k - groupStart) * channels;
+		
+		if(blend){
+			unsigned char* b = retainedRunForAge(group, MAX(age - 1, 0)) + (k - groupStart) * channels;
+			for(; k < groupEnd; k++){
+				unsigned char weight = levelWeights[delayMapLevels[retainedPixels[k]]];
+				for(int c = 0; c < channels; c++) {
+					lowerRun[runIndex + c] = a[c];
+					upperRun[runIndex + c] = b[c];
+					weightRun[runIndex + c] = weight;
+				}
+				a += channels;
+				b += channels;
+				runIndex += channels;
+			}
+		}
+		else{
+			for(; k < groupEnd; k++){
+				unsigned char *out = outbuffer + retainedPixels[k] * channels;
+				for(int c = 0; c < channels; c++) {
+					out[c] = a[c];
+				}
+				a += channels;
+			}
+		}
+	}
+	
+	if(blend){
+		ofxSlitScanKernels::getBlendFunction()(blendedRun, lowerRun, upperRun, weightRun, runBytes);
+		runIndex = 0;
+		for(int k = first; k < last; k++){
+			unsigned char *out = outbuffer + retainedPixels[k] * channels;
+			for(int c = 0; c < channels; c++) {
+				out[c] = blendedRun[runIndex + c];
+			}
+			runIndex += channels;
+		}
+	}
+}
+
+void ofxSlitScanCore::copyDelayMap(unsigned char* pixels, size_t stride){
+	waitForRender();
+	storeProceduralMap();
+	if(stride == 0){
+		stride = outputWidth;
+	}
+	int levelShift = delayMapLevelCount > 256 ? 8 : 0;
+	for(int y = 0; y < outputHeight; y++){
+		unsigned short* levels = delayMapLevels + y * outputWidth;
+		unsigned char* pix = pixels + y * stride;
+		for(int x = 0; x < outputWidth; x++){
+			pix[x] = levels[x] >> levelShift;
+		}
+	}
+}
+
+int ofxSlitScanCore::getWidth(){
+	return width;
+}
+
+int ofxSlitScanCore::getHeight(){
+	return height;
+}
+
+void ofxSlitScanCore::pixelsForFrame(int num, unsigned char* outbuf){
+	waitForRender();
+	if(sparseRetention){
+		updateRetention();
+		copyRetainedFrame(capacity - 1 - num, outbuf);
+		return;
+	}
+	int slot = frame_index(framepointer, num, capacity);
+	unsigned char* pixels = pixelsForSlot(slot);
+	if(pixels == NULL){
+		coldFrames.copyFrame(slot, outbuf);
+		return;
+	}
+	memcpy(outbuf, pixels, bytesPerFrame*sizeof(unsigned char));
+}
+
+ofxSlitScanCore::FrameView ofxSlitScanCore::getFrameView(int num){
+	waitForRender();
+	FrameView view;
+	view.pixels = NULL;
+	view.stride = width * bytesPerPixel;
+	view.frameId = 0;
+	view.slot = -1;
+	view.version = 0;
+	view.generation = historyGeneration;
+	if(!buffersAllocated){
+		return view;
+	}
+	num = MIN(MAX(num, 0), capacity - 1);
+	
+	//frames that aren't kept whole are put together in a copy the view holds
+	if(sparseRetention){
+		unsigned long long age = capacity - 1 - num;
+		view.frameId = framesAdded > age ? framesAdded - age : 0;
+		view.copy.reset(new vector<unsigned char>(bytesPerFrame));
+		pixelsForFrame(num, &(*view.copy)[0]);
+		view.pixels = &(*view.copy)[0];
+		return view;
+	}
+	
+	int slot = frame_index(framepointer, num, capacity);
+	view.frameId = slotFrameIds[slot];
+	view.slot = slot;
+	view.version = slotVersions[slot];
+	view.pixels = pixelsForSlot(slot);
+	if(view.pixels == NULL){
+		view.copy.reset(new vector<unsigned char>(bytesPerFrame));
+		coldFrames.copyFrame(slot, &(*view.copy)[0]);
+		view.pixels = &(*view.copy)[0];
+	}
+	return view;
+}
+
+bool ofxSlitScanCore::isCurrent(const FrameView& view){
+	if(view.generation != historyGeneration || view.frameId == 0){
+		return false;
+	}
+	if(view.slot < 0){
+		return view.frameId + capacity > framesAdded;
+	}
+	return view.slot < capacity && slotFrameIds[view.slot] == view.frameId && slotVersions[view.slot] == view.version;
+}
+
+bool ofxSlitScanCore::pinFrame(const FrameView& view){
+	waitForRender();
+	if(!isCurrent(view)){
+		return false;
+	}
+	//copies belong to the view already
+	if(view.copy){
+		return true;
+	}
+	
+	//the cold store would take the frame's pages away
+	if(pinnedFrames[view.frameId]++ == 0 && coldFrames.isSetup()){
+		coldFrames.cancel(view.slot);
+	}
+	return true;
+}
+
+void ofxSlitScanCore::unpinFrame(const FrameView& view){
+	waitForRender();
+	std::map<unsigned long long, int>::iterator pinned = pinnedFrames.find(view.frameId);
+	if(view.copy || pinned == pinnedFrames.end() || --pinned->second > 0){
+		return;
+	}
+	pinnedFrames.erase(pinned);
+	
+	//hand back the frames that were waiting on this one
+	for(size_t i = 0; i < pinnedReleases.size();){
+		if(pinnedReleases[i].frameId == view.frameId){
+			PinnedRelease released = pinnedReleases[i];
+			pinnedReleases.erase(pinnedReleases.begin() + i);
+			if(released.release){
+				released.release(released.image);
+			}
+		}
+		else{
+			i++;
+		}
+	}
+	
+	//it can be compressed now like any other
+	if(coldAge > 0 && view.generation == historyGeneration){
+		for(int frameAge = coldAge; frameAge < capacity; frameAge++){
+			queueColdFrame(frameAge);
+		}
+	}
+}
+
+void ofxSlitScanCore::releasePinnedFrames(){
+	pinnedFrames.clear();
+	vector<PinnedRelease> released;
+	released.swap(pinnedReleases);
+	for(size_t i = 0; i < released.size(); i++){
+		if(released[i].release){
+			released[i].release(released[i].image);
+		}
+	}
+}
+
+void ofxSlitScanCore::resetFrameIds(){
+	historyGeneration++;
+	slotFrameIds.assign(capacity, 0);
+	slotVersions.assign(capacity, 0);
+	arenaFrameIds.assign(capacity, 0);
+	slotTimes.assign(capacity, 0);
+}
+
+void ofxSlitScanCore::setThumbnails(int w, int h){
+	if(!buffersAllocated){
+		return;
+	}
+	w = MIN(MAX(w, 0), width);
+	h = MIN(MAX(h, 0), height);
+	if(w == thumbnailWidth && h == thumbnailHeight){
+		return;
+	}
+	thumbnailWidth = w;
+	thumbnailHeight = h;
+	thumbnailBytes = w * h * bytesPerPixel;
+	if(thumbnailBytes == 0){
+		thumbnailWidth = thumbnailHeight = 0;
+		vector<unsigned char>().swap(thumbnails);
+		return;
+	}
+	
+	//each thumbnail pixel averages the box of frame pixels it covers
+	thumbnailColumns.resize(w + 1);
+	for(int x = 0; x <= w; x++){
+		thumbnailColumns[x] = x * width / w;
+	}
+	thumbnailRows.resize(h + 1);
+	for(int y = 0; y <= h; y++){
+		thumbnailRows[y] = y * height / h;
+	}
+	
+	//catch up with the frames already in the history
+	thumbnails.assign((size_t)capacity * thumbnailBytes, 0);
+	reserveSlots();
+	for(int num = 0; num < capacity; num++){
+		updateThumbnail(frame_index(framepointer, num, capacity), getFrameView(num).pixels);
+	}
+}
+
+int ofxSlitScanCore::getThumbnailWidth(){
+	return thumbnailWidth;
+}
+
+int ofxSlitScanCore::getThumbnailHeight(){
+	return thumbnailHeight;
+}
+
+const unsigned char* ofxSlitScanCore::getThumbnail(int num){
+	if(thumbnailBytes == 0){
+		return NULL;
+	}
+	num = MIN(MAX(num, 0), capacity - 1);
+	return &thumbnails[frame_index(framepointer, num, capacity) * thumbnailBytes];
+}
+
+void ofxSlitScanCore::updateThumbnail(int slot, const unsigned char* pixels){
+	unsigned char* thumbnail = &thumbnails[slot * thumbnailBytes];
+	int rowBytes = thumbnailWidth * bytesPerPixel;
+	vector<unsigned int> sums(rowBytes);
+	for(int ty = 0; ty < thumbnailHeight; ty++){
+		int top = thumbnailRows[ty];
+		int bottom = MAX(thumbnailRows[ty + 1], top + 1);
+		
+		//add up the rows of the box, then each column span of them
+		std::fill(sums.begin(), sums.end(), 0);
+		for(int y = top; y < bottom; y++){
+			const unsigned char* row = pixels + y * width * bytesPerPixel;
+			for(int tx = 0; tx < thumbnailWidth; tx++){
+				int right = MAX(thumbnailColumns[tx + 1], thumbnailColumns[tx] + 1);
+				for(int x = thumbnailColumns[tx]; x < right; x++){
+					for(int c = 0; c < bytesPerPixel; c++){
+						sums[tx * bytesPerPixel + c] += row[x * bytesPerPixel + c];
+					}
+				}
+			}
+		}
+		for(int tx = 0; tx < thumbnailWidth; tx++){
+			unsigned int area = (bottom - top) * (MAX(thumbnailColumns[tx + 1], thumbnailColumns[tx] + 1) - thumbnailColumns[tx]);
+			for(int c = 0; c < bytesPerPixel; c++){
+				thumbnail[tx * bytesPerPixel + c] = (sums[tx * bytesPerPixel + c] + area / 2) / area;
+			}
+		}
+		thumbnail += rowBytes;
+	}
+}
+
+unsigned char* ofxSlitScanCore::pixelsForSlot(int slot){
+	if(adoptedFrames[slot] != NULL){
+		return adoptedFrames[slot];
+	}
+	//cold frames are read through the cold store
+	if(coldFrames.isSetup() && coldFrames.isCold(slot)){
+		return NULL;
+	}
+	if(!frameWritten[slot]){
+		return emptyFrame.getData();
+	}
+	return cellPixels(slot);
+}
+
+unsigned char* ofxSlitScanCore::cellPixels(int slot){
+	return slotCells[slot].block->getData() + slotCells[slot].offset;
+}
+
+void ofxSlitScanCore::releaseSlot(int slot){
+	//a compressed copy goes stale as soon as the slot is let go
+	if(coldFrames.isSetup()){
+		coldFrames.cancel(slot);
+	}
+	
+	if(adoptedFrames[slot] == NULL){
+		return;
+	}
+	unsigned char* image = adoptedFrames[slot];
+	ReleaseCallback release = adoptedReleases[slot];
+	adoptedFrames[slot] = NULL;
+	adoptedReleases[slot] = ReleaseCallback();
+	
+	//pinned frames are handed back once they are unpinned
+	if(pinnedFrames.count(slotFrameIds[slot]) > 0){
+		PinnedRelease pinned = {slotFrameIds[slot], image, release};
+		pinnedReleases.push_back(pinned);
+		return;
+	}
+	if(release){
+		release(image);
+	}
+}
+
+void ofxSlitScanCore::releaseAllSlots(){
+	for(int i = 0; i < capacity; i++){
+		releaseSlot(i);
+	}
+}
+
+void ofxSlitScanCore::setTimeDelayAndWidth(int _timeDelay, int _timeWidth){
+	waitForRender();
+	timeDelay = clamp(_timeDelay, 0, capacity-1);
+	timeWidth = clamp(_timeWidth, 1, capacity);
+	if(timeDelay + timeWidth > capacity){
+		log(LOG_ERROR, "ofxSlitScan -- Invalid time delay and width specified, adds to %d with a capacity of %d", (timeDelay+timeWidth), capacity);
+		timeDelay = 0;
+		timeWidth = capacity;
+	}
+	delayLUTIsDirty = true;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::setTimeDelay(int _timeDelay){
+	waitForRender();
+	timeDelay = clamp(_timeDelay, 0, capacity - timeWidth - 1);
+	delayLUTIsDirty = true;
+	markOutputDirty();
+}
+
+void ofxSlitScanCore::setTimeWidth(int _timeWidth){
+	waitForRender();
+	timeWidth = clamp(_timeWidth, 1, capacity - timeDelay);
+	delayLUTIsDirty = true;
+	markOutputDirty();
+}
+
+int ofxSlitScanCore::getCapacity(){
+	return capacity;
+}
+
+int ofxSlitScanCore::getTimeDelay(){
+	return timeDelay;
+}
+
+int ofxSlitScanCore::getTimeWidth(){
+	return timeWidth;
+}
+
+int ofxSlitScanCore::getChannels(){
+	return bytesPerPixel;
+}
+
+bool ofxSlitScanCore::isBlending(){	
+	return blend;
+}
+
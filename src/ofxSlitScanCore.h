@@ -0,0 +1,816 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanCore.h
+ *
+ * The slit scan engine without openFrameworks. It keeps the frame
+ * history, the delay map and the render, and works on plain pixel
+ * buffers of 1, 3 or 4 interleaved 8 bit channels. Rows of the buffers
+ * passed in can be padded, pass their length in bytes as the stride,
+ * or 0 for tightly packed rows.
+ *
+ * ofxSlitScan wraps this for use with ofImage and ofPixels, use it
+ * directly where openFrameworks isn't around.
+ */
+
+#ifndef _OFX_SLITSCAN_CORE
+#define _OFX_SLITSCAN_CORE
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "ofxSlitScanThreadPool.h"
+#include "ofxSlitScanKernels.h"
+#include "ofxSlitScanArena.h"
+#include "ofxSlitScanColdStore.h"
+#include "ofxSlitScanRing.h"
+#include "ofxSlitScanConvert.h"
+#include "ofxSlitScanIngestQueue.h"
+
+class ofxSlitScanCore
+{
+  public:
+	ofxSlitScanCore();
+	~ofxSlitScanCore();
+	
+	/**
+	 * Width / Height of input stream
+	 * capcity sets the maximum number of frames to
+	 * be held. 
+	 * channels is 1, 3 or 4
+	 */
+	void setup(int w, int h, int capacity, int channels = 3);
+	bool isSetup();
+	
+	/**
+	 * set the map used to distort the frame buffer. Without a size
+	 * the map has the dimensions of the output, which are the ones of
+	 * the input stream unless setOutputSize changed them. Maps of
+	 * any other size are resampled to the output.
+	 * White pixels map to the newest frames and black the oldest,
+	 * gray in between. Maps with 3 or 4 channels use their luminance,
+	 * float maps go from 0.0 to 1.0
+	 */
+	void setDelayMap(const unsigned char* map, int channels, size_t stride = 0);
+	void setDelayMap(const unsigned char* map, int w, int h, int channels, size_t stride = 0);
+	void setDelayMap(const float* map, size_t stride = 0);
+	void setDelayMap(const float* map, int w, int h, size_t stride = 0);
+	
+	/**
+	 * a map that is a function of the position instead of an image. It is
+	 * worked out a row at a time as the output renders, so nothing is
+	 * stored or read per pixel and changing it every frame costs no more
+	 * than leaving it. Points are in 0.0 - 1.0 of the output size.
+	 * MAP_LINEAR goes from 0 at the first point to 1 at the second,
+	 * MAP_RADIAL from 0 at the first point to 1 as far out as the second,
+	 * MAP_ANGULAR from 0 to 1 once around the first point, starting at the second,
+	 * MAP_SINE waves between 0 and 1 frequency times from the first point
+	 * to the second, shifted by phase radians.
+	 * Bucketed rendering, sparse retention, getStats and copyDelayMap need
+	 * the whole map and store it when they use it
+	 */
+	enum MapShape {
+		MAP_LINEAR,
+		MAP_RADIAL,
+		MAP_ANGULAR,
+		MAP_SINE
+	};
+	struct ProceduralMap {
+		MapShape shape;
+		float x0, y0;
+		float x1, y1;
+		float frequency;
+		float phase;
+	};
+	void setDelayMap(const ProceduralMap& map);
+	bool isDelayMapProcedural();
+	
+	/**
+	 * renders the output at w x h instead of the size of the input
+	 * stream. Every output pixel samples the history where it falls,
+	 * nearest or bilinear, in the same pass that gathers it, so a small
+	 * preview or an upscaled output costs one render at its own size.
+	 * The delay map is resampled to the new size, and a buffer given
+	 * to setOutputBuffer is let go. setup goes back to the input size.
+	 * Bucketed rendering is skipped and sparse retention can't be used
+	 * while the sizes differ
+	 */
+	enum Resampling {
+		RESAMPLE_NEAREST,
+		RESAMPLE_BILINEAR
+	};
+	void setOutputSize(int w, int h, Resampling resampling = RESAMPLE_BILINEAR);
+	int getOutputWidth();
+	int getOutputHeight();
+	Resampling getResampling();
+	
+	/**
+	 * optional transfer curve applied to the delay map values.
+	 * the curve is sampled evenly over 0.0 - 1.0 and maps map
+	 * values to new values in 0.0 - 1.0. Changing the curve only
+	 * rebuilds the level lookup table, not the per pixel map.
+	 * pass an empty curve to turn it off.
+	 */
+	void setTransferCurve(const std::vector<float>& curve);
+	
+	/**
+	 * copies a frame into the history
+	 * call this in succession, once per frame
+	 */
+	void addFrame(const unsigned char* pixels, size_t stride = 0);
+	
+	/**
+	 * adds a w x h frame of any pixel format, scaled to the size of the
+	 * history and converted to its channels in one pass straight into
+	 * its slot. stride is the length of a row in bytes, 0 for packed rows.
+	 * See ofxSlitScanConvert for the formats
+	 */
+	typedef ofxSlitScanConvert::Format PixelFormat;
+	void addFrame(const unsigned char* pixels, int w, int h, PixelFormat format, size_t stride = 0,
+				  Resampling resampling = RESAMPLE_BILINEAR);
+	
+	/**
+	 * zero copy ingest. beginFrame returns the slot in the history the
+	 * next frame goes into. Write, decode or capture width*height*channels
+	 * bytes straight into it, then call commitFrame to add it.
+	 * Don't get the output in between the two calls.
+	 */
+	unsigned char* beginFrame();
+	void commitFrame();
+	
+	/**
+	 * adds a caller owned frame to the history without copying it.
+	 * The frame has to stay valid until release is called with it,
+	 * which happens once it falls out of the history
+	 */
+	typedef std::function<void(unsigned char* image)> ReleaseCallback;
+	void adoptFrame(unsigned char* pixels, ReleaseCallback release);
+	
+	/**
+	 * decides which of the frames offered to addFrame, beginFrame and
+	 * adoptFrame go into the history, so a long history or a slow render
+	 * doesn't hold up the source. The frames turned away are dropped,
+	 * adopted ones are released straight away.
+	 * ADMIT_ALL stores every frame, the default.
+	 * ADMIT_EVERY stores every amount'th frame.
+	 * ADMIT_FRAME_RATE stores up to amount frames per second of wall clock.
+	 * ADMIT_ADAPTIVE stores as many frames as it can while storing and
+	 * rendering them takes no more than amount seconds per offered frame,
+	 * skipping more frames when the render falls behind and fewer once it
+	 * catches up.
+	 * Every stored frame stands in for the ones skipped after it, so the
+	 * same capacity covers a longer time. Under the last two policies
+	 * frames come in unevenly, and the delay map is retimed by the time
+	 * each frame was stored, so a map value is always the same age in
+	 * seconds. That doesn't apply to sparse retention
+	 */
+	enum Admission {
+		ADMIT_ALL,
+		ADMIT_EVERY,
+		ADMIT_FRAME_RATE,
+		ADMIT_ADAPTIVE
+	};
+	void setAdmission(Admission admission, double amount = 0);
+	Admission getAdmission();
+	
+	/**
+	 * whether the next frame offered will be stored. Check before
+	 * decoding one for beginFrame to skip the work for frames that
+	 * would be dropped
+	 */
+	bool admitsNextFrame();
+	
+	/**
+	 * 1 in how many offered frames is stored at the moment, what
+	 * ADMIT_ADAPTIVE settled on
+	 */
+	int getAdmittedEvery();
+	
+	/**
+	 * lets a capture thread hand frames over while the thread that owns
+	 * the slit scan renders. One producer thread queues frames with
+	 * queueFrame, or beginQueuedFrame and commitQueuedFrame, without
+	 * taking a lock. They wait until the owning thread takes them into
+	 * the history with takeQueuedFrames, which getOutput does first, so
+	 * only the owning thread touches the history and every render sees
+	 * whole frames. Up to depth frames wait, policy says what happens to
+	 * a frame queued when they're all waiting, see ofxSlitScanIngestQueue.
+	 * The queue functions return false for frames that were dropped.
+	 * Frames taken in go through the admission policy like any other.
+	 * Depth 0 turns the queue off.
+	 * setIngestQueue and setup empty the queue, so stop the producer
+	 * first. closeIngestQueue fails every frame queued after it and lets
+	 * a producer waiting on a full queue go
+	 */
+	typedef ofxSlitScanIngestQueue::Policy IngestPolicy;
+	void setIngestQueue(int depth, IngestPolicy policy = ofxSlitScanIngestQueue::DROP_OLDEST);
+	void closeIngestQueue();
+	unsigned char* beginQueuedFrame();
+	bool commitQueuedFrame();
+	bool queueFrame(const unsigned char* pixels, size_t stride = 0);
+	bool queueFrame(const unsigned char* pixels, int w, int h, PixelFormat format, size_t stride = 0,
+					Resampling resampling = RESAMPLE_BILINEAR);
+	
+	/**
+	 * takes up to a queue's worth of waiting frames into the history and
+	 * returns how many. Only call from the owning thread
+	 */
+	int takeQueuedFrames();
+	
+	/**
+	 * renders the distortion if anything changed since the last
+	 * call and returns the tightly packed output. version, if given,
+	 * is set to the version of the output returned
+	 */
+	const unsigned char* getOutput(unsigned long long* version = NULL);
+	bool isOutputDirty();
+	
+	/**
+	 * turn on to render on a background thread. Every committed frame
+	 * starts a render into a back buffer, and getOutput returns the last
+	 * finished one. With allowLatency on, getOutput never waits and may
+	 * hand back the previous frame's output while the newest renders.
+	 * With it off getOutput waits for the newest frame, which still
+	 * overlaps the render with whatever the caller does in between.
+	 * Adding a frame waits for a render that is still reading the slot
+	 * it goes into. The output stays valid until the next frame is added.
+	 */
+	void setAsyncRendering(bool async, bool allowLatency = true);
+	bool isAsyncRendering();
+	
+	/**
+	 * goes up every time a new output is finished
+	 */
+	unsigned long long getOutputVersion();
+	
+	/**
+	 * renders straight into pixels from now on instead of an internal
+	 * buffer. pixels has to hold a tightly packed output and stay valid
+	 * until the next setup or setOutputSize, pass NULL to go back to the
+	 * internal buffer. Not used while rendering asynchronously
+	 */
+	void setOutputBuffer(unsigned char* pixels);
+	
+	/**
+	 * renders if needed and copies the output to pixels
+	 */
+	void copyOutput(unsigned char* pixels, size_t stride = 0);
+	
+	/**
+	 * renders only the w x h rectangle at x, y of the output into pixels,
+	 * stride bytes apart per row, 0 for tightly packed. Costs about the
+	 * rectangle's share of a full render. Nothing is rendered if the same
+	 * rectangle went into the same pixels since the last change, so don't
+	 * write to them in between. Always renders on the calling thread, and
+	 * with sparse retention the full output is rendered and cropped.
+	 * Returns false if the rectangle isn't inside the output
+	 */
+	bool renderRegion(int x, int y, int w, int h, unsigned char* pixels, size_t stride = 0);
+	
+	/**
+	 * more outputs from the same history, each with a delay map, delay,
+	 * width and blending of its own. They are the size of the history
+	 * and are rendered along with the main output, band by band in the
+	 * same pass unless the main output is resampled, bucketed or sparse.
+	 * A new output starts with a black map, no delay and the full
+	 * capacity as width. Maps of another size are resampled bilinearly.
+	 * The transfer curve applies to all outputs.
+	 * Named outputs can't be used with sparse retention, which only keeps
+	 * what the main map reads. setup removes them all
+	 */
+	bool addOutput(const std::string& name);
+	void removeOutput(const std::string& name);
+	bool hasOutput(const std::string& name);
+	std::vector<std::string> getOutputNames();
+	void setOutputDelayMap(const std::string& name, const unsigned char* map, int w, int h, int channels, size_t stride = 0);
+	void setOutputDelayMap(const std::string& name, const float* map, int w, int h, size_t stride = 0);
+	void setOutputTimeDelayAndWidth(const std::string& name, int timeDelay, int timeWidth);
+	void setOutputBlending(const std::string& name, bool blend);
+	const unsigned char* getOutput(const std::string& name, unsigned long long* version = NULL);
+	
+	/**
+	 * copies the delay map as 8 bit gray to pixels, at the output size
+	 */
+	void copyDelayMap(unsigned char* pixels, size_t stride = 0);
+	
+	/**
+	 * fills outbuf with the undistorted pixels 
+	 * for frame "num".
+	 */
+	void pixelsForFrame(int num, unsigned char* outbuf);
+	
+	/**
+	 * the pixels of frame "num" without copying them, rows stride bytes
+	 * apart. frameId counts frames as they are added, starting at 1, and
+	 * is 0 for a slot that was never written.
+	 * Frames in the history point straight into it. Compressed frames and
+	 * frames under sparse retention are put together in a copy the view
+	 * holds on to instead.
+	 * A view goes stale when its frame is replaced or moved, which
+	 * isCurrent tells you. Pin a view to keep its pixels where they are
+	 * while new frames come in, new frames go next to a pinned one
+	 * instead of over it. Unpin it once done, every pin needs an unpin.
+	 * setup, setCapacity, setHistoryDirectory and setSparseRetention move
+	 * the history and leave every view stale, pinned or not
+	 */
+	struct FrameView {
+		const unsigned char* pixels;
+		size_t stride;
+		unsigned long long frameId;
+		int slot;
+		unsigned long long version;
+		unsigned long long generation;
+		std::shared_ptr<std::vector<unsigned char> > copy;
+	};
+	FrameView getFrameView(int num);
+	bool isCurrent(const FrameView& view);
+	bool pinFrame(const FrameView& view);
+	void unpinFrame(const FrameView& view);
+	
+	/**
+	 * keeps a w x h thumbnail of every frame in the history, made as the
+	 * frame is added, for showing the history without copying out whole
+	 * frames. getThumbnail returns the tightly packed thumbnail of frame
+	 * "num", numbered like pixelsForFrame. It stays valid until the frame
+	 * is replaced. Pass 0 to turn thumbnails off
+	 */
+	void setThumbnails(int w, int h);
+	int getThumbnailWidth();
+	int getThumbnailHeight();
+	const unsigned char* getThumbnail(int num);
+	
+	/**
+	 * reset the maxmum delay. The frames that are kept stay in order,
+	 * growing adds empty frames older than the oldest and shrinking lets
+	 * the oldest go. Within the reserved capacity nothing is allocated or
+	 * copied, past it another block of history is reserved. Compressed
+	 * frames stay compressed
+	 */
+	void setCapacity(int capacity);
+	
+	/**
+	 * reserves room for frames frames of history up front, so setCapacity
+	 * can go up to that many without allocating. Only address space is
+	 * reserved, memory is still taken as frames are written. Can be called
+	 * before setup, the reservation is kept until the next one
+	 */
+	void reserveCapacity(int frames);
+	int getReservedCapacity();
+	
+	/**
+	 * Allows clamping of the delay amount and width of the delay within the capacity
+	 * timeDelay + timeWidth must be less than the total capacity.
+	 * these values can be scrubbed in real time for glitch and speed ramp effects
+	 */
+	void setTimeDelayAndWidth(int timeDelay, int timeWidth); 
+	void setTimeDelay(int timeDelay);
+	void setTimeWidth(int timeWidth);
+	
+	/**
+	 * turn on to smooth inter-frame differences
+	 * blending uses 8 bit fixed point weights, see ofxSlitScanKernels.h
+	 */
+	void setBlending(bool blend);
+	void toggleBlending();
+	
+	/**
+	 * number of threads used to render the output, including
+	 * the calling thread. The output is split into bands of rows
+	 * that the threads pull from as they finish.
+	 * default is 1, pass 0 to use one thread per core
+	 */
+	void setNumThreads(int numThreads);
+	int getNumThreads();
+	
+	/**
+	 * turn on to render the output one source frame at a time instead
+	 * of row by row. Output pixels are sorted by the frame they read
+	 * from whenever the map, delay or width change, so each frame is
+	 * streamed through once per render. Helps a lot with noisy maps
+	 * that jump between many frames from pixel to pixel.
+	 */
+	void setBucketedRendering(bool bucketed);
+	bool isBucketedRendering();
+	
+	/**
+	 * turn on to keep only the history the current map will still read.
+	 * Each pixel keeps a delay line exactly as long as the deepest frame
+	 * its map value reaches, so maps that stay near the present, or a
+	 * delay and width that only use part of the capacity, need far less
+	 * memory than capacity full frames.
+	 * Changing the map, delay, width or capacity while this is on
+	 * rebuilds the retained history. Pixels that now reach further back
+	 * than was kept come back black until the history fills in again.
+	 */
+	void setSparseRetention(bool sparse);
+	bool isSparseRetention();
+	
+	/**
+	 * compresses frames losslessly once they are older than age frames,
+	 * 0 turns it off. Compression runs on a background thread and the
+	 * render expands old frames a block of rows at a time, keeping the
+	 * most recently used blocks in a small cache.
+	 * Only applies to the full history, not sparse retention.
+	 */
+	void setColdCompression(int age);
+	int getColdCompression();
+	void setColdCacheSize(int blocks);
+	
+	/**
+	 * keeps the full history in a scratch file in directory instead of
+	 * memory, so it can hold far more frames than fit in RAM. Put it on a
+	 * fast local drive. Only the frames inside the delay and width window
+	 * are read ahead, new frames are flushed as they come in.
+	 * Pass an empty string to go back to memory. Returns false and keeps
+	 * the current history if the file can't be made
+	 */
+	bool setHistoryDirectory(const std::string& directory);
+	std::string getHistoryDirectory();
+	
+	/**
+	 * bytes of memory the frame history currently takes up
+	 */
+	size_t getHistoryBytes();
+	
+	/**
+	 * counters since setup or the last resetStats. They only cost a
+	 * clock read around each call, the age histogram is worked out
+	 * from the map when getStats is called.
+	 */
+	struct Stats {
+		//frames added, frames the admission policy turned away, frames
+		//the ingest queue dropped, seconds spent copying them in with
+		//addFrame, and seconds spent committing them to the history
+		unsigned long long framesAdded;
+		unsigned long long framesSkipped;
+		unsigned long long framesDropped;
+		double ingestSeconds;
+		double commitSeconds;
+		
+		//calls to getOutput and how many of them had to render,
+		//the rest were served from the last render
+		unsigned long long outputRequests;
+		unsigned long long renders;
+		unsigned long long blendRenders;
+		double renderSeconds;
+		double blendRenderSeconds;
+		
+		//renderRegion calls that had to render, the pixels they rendered
+		//and the seconds they took
+		unsigned long long regionRenders;
+		unsigned long long regionPixels;
+		double regionSeconds;
+		
+		//history bytes gathered and output bytes written by the renders
+		unsigned long long bytesRead;
+		unsigned long long bytesWritten;
+		
+		//how many pixels the current map samples from each frame age,
+		//0 is the newest frame, and how many ages it samples at all
+		std::vector<unsigned int> ageHistogram;
+		int framesTouched;
+	};
+	const Stats& getStats();
+	void resetStats();
+	
+	int getTimeDelay();
+	int getTimeWidth();
+	int getWidth();
+	int getHeight();
+	int getCapacity();
+	int getChannels();
+	bool isBlending();
+	
+	
+	enum LogLevel {
+		LOG_WARNING,
+		LOG_ERROR
+	};
+	typedef std::function<void(LogLevel level, const std::string& message)> LogFunction;
+	
+	/**
+	 * where warnings and errors go, stderr by default
+	 */
+	static void setLogFunction(LogFunction log);
+	
+  protected:
+	//the history lives in reserved blocks of cells frameStride apart. Each
+	//slot of the ring owns a cell, so resizing hands cells between slots
+	//instead of moving frames. Slots that were never written read from a
+	//shared empty frame instead
+	struct Cell {
+		ofxSlitScanArena* block;
+		size_t offset;
+	};
+	std::vector<std::shared_ptr<ofxSlitScanArena> > frameBlocks;
+	std::vector<Cell> slotCells;
+	std::vector<Cell> freeCells;
+	int reservedCapacity;
+	ofxSlitScanArena emptyFrame;
+	std::vector<bool> frameWritten;
+	size_t frameStride;
+	unsigned char* pixelsForSlot(int slot);
+	unsigned char* cellPixels(int slot);
+	bool reserveHistory();
+	bool addHistoryBlock(int cells);
+	void releaseHistory();
+	void reserveSlots();
+	void resizeSlots(int first, int change);
+	bool resizeHistory(int slots);
+	bool isHistoryFileBacked();
+	
+	//a file backed history is read ahead around the delay and width window
+	std::string historyDirectory;
+	bool allocateHistory(ofxSlitScanArena& arena, int slots);
+	bool moveHistory();
+	void historyWindow(int& nearest, int& furthest);
+	void adviseHistoryWindow();
+	void adviseNewFrame(int slot);
+	
+	//frames adopted from the caller replace their slot until they are released
+	std::vector<unsigned char*> adoptedFrames;
+	std::vector<ReleaseCallback> adoptedReleases;
+	void releaseSlot(int slot);
+	void releaseAllSlots();
+	void advanceFrame(const unsigned char* pixels);
+	
+	//frame views check the id and version of their slot, and the
+	//generation of the history, which changes when it is reallocated.
+	//arenaFrameIds are the frames whose pixels are in each arena slot
+	std::vector<unsigned long long> slotFrameIds;
+	std::vector<unsigned long long> slotVersions;
+	std::vector<unsigned long long> arenaFrameIds;
+	unsigned long long historyGeneration;
+	void resetFrameIds();
+	
+	//frames offered go through the admission policy first. admitCountdown
+	//is the frames to skip before the next one is stored. With frames
+	//stored unevenly the level offsets are moved to the ones stored at
+	//the right time, slotTimes are when each slot was stored
+	Admission admission;
+	double admissionAmount;
+	int admittedEvery;
+	int admitCountdown;
+	bool frameAdmitted;
+	double nextAdmitTime;
+	double admittedAt;
+	double admissionCost;
+	double admissionRenderSeconds;
+	std::vector<unsigned char> skippedFrame;
+	ofxSlitScanConvert ingestConvert;
+	std::vector<double> slotTimes;
+	
+	//frames queued from another thread. queueConvert belongs to the
+	//producer thread, ingestConvert to the owning one
+	int ingestDepth;
+	IngestPolicy ingestPolicy;
+	ofxSlitScanIngestQueue ingestQueue;
+	ofxSlitScanConvert queueConvert;
+	bool offerFrame();
+	void adaptAdmission();
+	bool isRetimed();
+	float retimedOffset(float offset);
+	unsigned char* beginAdmittedFrame();
+	
+	//pin counts by frame id. A pinned arena frame isn't written over,
+	//the next frame for its slot goes in pinnedReplacement. Adopted
+	//frames that leave while pinned wait in pinnedReleases
+	struct PinnedRelease {
+		unsigned long long frameId;
+		unsigned char* image;
+		ReleaseCallback release;
+	};
+	std::map<unsigned long long, int> pinnedFrames;
+	std::vector<PinnedRelease> pinnedReleases;
+	unsigned char* pinnedReplacement;
+	void releasePinnedFrames();
+	
+	//one thumbnail per slot, averaged over the frame pixel spans in
+	//thumbnailColumns and thumbnailRows
+	int thumbnailWidth;
+	int thumbnailHeight;
+	int thumbnailBytes;
+	std::vector<unsigned char> thumbnails;
+	std::vector<int> thumbnailColumns;
+	std::vector<int> thumbnailRows;
+	void updateThumbnail(int slot, const unsigned char* pixels);
+	
+	//frames past coldAge move into the cold store and leave the arena
+	int coldAge;
+	ofxSlitScanColdStore coldFrames;
+	std::vector<int> coldCollected;
+	bool renderReadsColdFrames;
+	void collectColdFrames();
+	void queueColdFrame(int age);
+	void thawColdFrames();
+	
+	bool blend;
+	
+	//the delay map is stored as quantized levels, 256 for 8 bit maps and
+	//65536 for float or color maps. each level resolves through a lookup
+	//table to a frame offset and blend weight, so changing the delay and
+	//width only rebuilds the table and never touches the per pixel map
+	//delayMapLevels is the map resampled to the output, mapLevels the one passed in
+	unsigned short * delayMapLevels;
+	int delayMapLevelCount;
+	std::vector<unsigned short> mapLevels;
+	int mapWidth;
+	int mapHeight;
+	void updateOutputMap();
+	
+	//a procedural map is worked out per row by the render and only
+	//stored in delayMapLevels for the paths that need all of it
+	bool mapIsProcedural;
+	bool proceduralMapIsStored;
+	ProceduralMap proceduralMap;
+	void proceduralRow(int y, int left, int right, unsigned short* levels);
+	void proceduralLevelRange(int& lowest, int& highest);
+	void storeProceduralMap();
+	
+	//byte offsets into a frame of the rows and pixels each output row
+	//and column reads, and the bilinear weights between them
+	int outputWidth;
+	int outputHeight;
+	int outputBytes;
+	Resampling resampling;
+	bool outputIsResampled;
+	std::vector<int> resampleTop;
+	std::vector<int> resampleBottom;
+	std::vector<unsigned char> resampleRowWeights;
+	std::vector<int> resampleLeft;
+	std::vector<int> resampleRight;
+	std::vector<unsigned char> resampleColumnWeights;
+	void updateResampling();
+	std::vector<float> transferCurve;
+	
+	bool delayLUTIsDirty;
+	void updateDelayLUT();
+	void updateLevelOffsets(int levelCount, int timeDelay, int timeWidth,
+							std::vector<int>& lowerOffsets, std::vector<int>& upperOffsets, std::vector<unsigned char>& weights);
+	std::vector<int> levelLowerOffsets;
+	std::vector<int> levelUpperOffsets;
+	std::vector<unsigned char> levelWeights;
+	std::vector<unsigned char*> levelLowerFrames;
+	std::vector<unsigned char*> levelUpperFrames;
+	std::vector<int> levelLowerSlots;
+	std::vector<int> levelUpperSlots;
+	
+	ofxSlitScanThreadPool threadPool;
+	void renderRows(int startRow, int endRow);
+	void renderRect(int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride);
+	
+	//what a render reads for each pixel's map level, for any of the outputs
+	struct LevelTable {
+		const unsigned short* levels;
+		const unsigned char* weights;
+		unsigned char* const* lowerFrames;
+		unsigned char* const* upperFrames;
+		const int* lowerSlots;
+		const int* upperSlots;
+		bool blend;
+		bool cold;
+		bool procedural;
+	};
+	void renderLevels(const LevelTable& table, int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride);
+	template<int channels, bool cold> void renderRectWithChannels(const LevelTable& table, int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride);
+	template<int channels> void renderResampledRect(int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride);
+	template<int channels, bool cold, bool bilinear> void renderResampledRectWithChannels(int left, int right, int startRow, int endRow, unsigned char* pixels, size_t stride);
+	
+	//output pixel indices sorted by the frame offset they read from
+	bool bucketed;
+	bool bucketsAreDirty;
+	std::vector<int> bucketStarts;
+	std::vector<unsigned int> bucketPixels;
+	void updateBuckets();
+	void renderBuckets(int first, int last);
+	template<int channels, bool cold> void renderBucketsWithChannels(int first, int last);
+	
+	//sparse retention keeps one delay line per bucket of pixels. The lines of
+	//group g hold retainedLengths[g] runs of its pixels in bucket order,
+	//the run for frame number f sits at (f % length)
+	bool sparseRetention;
+	ofxSlitScanArena retainedFrames;
+	std::vector<int> retainedStarts;
+	std::vector<int> retainedLengths;
+	std::vector<size_t> retainedOffsets;
+	std::vector<unsigned int> retainedPixels;
+	std::vector<unsigned char> retainedStaging;
+	unsigned long long framesAdded;
+	void updateRetention();
+	void writeRetainedFrame(unsigned char* image);
+	void copyRetainedFrame(int age, unsigned char* outbuf);
+	unsigned char* retainedRunForAge(int group, int age);
+	void renderRetained(int first, int last);
+	template<int channels> void renderRetainedWithChannels(int first, int last);
+
+	//the output is rendered into outputBuffer, which is outputPixels
+	//unless the caller handed over a buffer of its own
+	bool outputIsDirty;
+	std::vector<unsigned char> outputPixels;
+	unsigned char* outputBuffer;
+	unsigned char* callerBuffer;
+	unsigned long long outputVersion;
+	double renderStart;
+	void prepareRender();
+	void renderOutput();
+	void markOutputDirty();
+	
+	//named outputs have their own map at the size of the history and
+	//their own level table. pixels is what getOutput returns, asynchronous
+	//renders go to backPixels and are swapped in when done
+	struct NamedOutput {
+		std::string name;
+		std::vector<unsigned short> levels;
+		int levelCount;
+		int timeDelay;
+		int timeWidth;
+		bool blend;
+		bool levelsAreDirty;
+		bool readsOldest;
+		bool readsColdFrames;
+		std::vector<int> lowerOffsets;
+		std::vector<int> upperOffsets;
+		std::vector<unsigned char> weights;
+		std::vector<unsigned char*> lowerFrames;
+		std::vector<unsigned char*> upperFrames;
+		std::vector<int> lowerSlots;
+		std::vector<int> upperSlots;
+		std::vector<unsigned char> pixels;
+		std::vector<unsigned char> backPixels;
+	};
+	std::vector<NamedOutput> namedOutputs;
+	NamedOutput* findOutput(const std::string& name);
+	void updateOutputLevels(NamedOutput& output);
+	void resolveOutputFrames(NamedOutput& output);
+	void renderOutputRows(NamedOutput& output, int startRow, int endRow);
+	
+	//regions rendered since the last change, with the change they saw.
+	//A region asked for again into the same pixels is left as it is
+	struct RenderedRegion {
+		int x, y, w, h;
+		unsigned char* pixels;
+		size_t stride;
+		unsigned long long version;
+	};
+	std::vector<RenderedRegion> renderedRegions;
+	unsigned long long changeVersion;
+	
+	//asynchronous rendering draws into backPixels on renderThread and
+	//swaps it with frontPixels when done. The rest of the state belongs
+	//to the caller's thread, which waits for the render before changing it
+	bool asyncRendering;
+	bool asyncAllowsLatency;
+	std::vector<unsigned char> frontPixels;
+	std::vector<unsigned char> backPixels;
+	std::thread renderThread;
+	std::mutex renderMutex;
+	std::condition_variable renderCondition;
+	bool renderRunning;
+	bool renderStopping;
+	bool renderReadsOldest;
+	void renderLoop();
+	void startRender();
+	void waitForRender();
+	void stopRenderThread();
+	
+	int timeWidth, timeDelay, framepointer, capacity;
+	int width, height;
+	
+	int bytesPerPixel;
+	int bytesPerFrame;
+	bool buffersAllocated;
+	
+	Stats stats;
+	std::vector<unsigned int> levelPixelCounts;
+	bool levelPixelCountsAreDirty;
+	void updateLevelPixelCounts();
+};
+
+#endif
@@ -0,0 +1,196 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanIngestQueue.cpp
+ */
+
+#include "ofxSlitScanIngestQueue.h"
+#include <thread>
+
+ofxSlitScanIngestQueue::ofxSlitScanIngestQueue()
+:depth(0), frameBytes(0), policy(DROP_OLDEST), head(0), tail(0), freeHead(0), freeTail(0),
+ writeBuffer(-1), readBuffer(-1), dropped(0), producerWaiting(false), closed(false) {
+}
+
+ofxSlitScanIngestQueue::~ofxSlitScanIngestQueue(){
+	close();
+}
+
+void ofxSlitScanIngestQueue::setup(int _depth, size_t _frameBytes, Policy _policy){
+	close();
+	depth = _depth > 0 && _frameBytes > 0 ? _depth : 0;
+	frameBytes = _frameBytes;
+	policy = _policy;
+	head = tail = freeHead = 0;
+	freeTail = 0;
+	readBuffer = -1;
+	dropped = 0;
+	if(depth == 0){
+		std::vector<unsigned char>().swap(buffers);
+		queued.clear();
+		freeBuffers.clear();
+		writeBuffer = -1;
+		return;
+	}
+	
+	//the producer starts out with buffer 0 and the rest are free
+	int count = depth + 2;
+	buffers.assign(count * frameBytes, 0);
+	std::vector<std::atomic<int> >(depth).swap(queued);
+	std::vector<std::atomic<int> >(count).swap(freeBuffers);
+	for(int i = 0; i < depth; i++){
+		queued[i].store(-1, std::memory_order_relaxed);
+	}
+	for(int i = 0; i < count; i++){
+		freeBuffers[i].store(i + 1 < count ? i + 1 : -1, std::memory_order_relaxed);
+	}
+	freeHead = count - 1;
+	writeBuffer = 0;
+	closed = false;
+}
+
+bool ofxSlitScanIngestQueue::isSetup(){
+	return depth > 0;
+}
+
+void ofxSlitScanIngestQueue::close(){
+	closed = true;
+	std::lock_guard<std::mutex> lock(waitMutex);
+	spaceCondition.notify_all();
+}
+
+int ofxSlitScanIngestQueue::getDepth(){
+	return depth;
+}
+
+ofxSlitScanIngestQueue::Policy ofxSlitScanIngestQueue::getPolicy(){
+	return policy;
+}
+
+unsigned char* ofxSlitScanIngestQueue::buffer(int index){
+	return &buffers[index * frameBytes];
+}
+
+unsigned char* ofxSlitScanIngestQueue::beginPush(){
+	return depth == 0 ? NULL : buffer(writeBuffer);
+}
+
+bool ofxSlitScanIngestQueue::commitPush(){
+	if(depth == 0 || closed){
+		return false;
+	}
+	
+	unsigned long long h = head.load(std::memory_order_relaxed);
+	int spare = -1;
+	while(h - tail.load(std::memory_order_acquire) >= (unsigned long long)depth){
+		if(closed){
+			return false;
+		}
+		if(policy == DROP_NEWEST){
+			//the frame stays in writeBuffer and the next one goes over it
+			dropped++;
+			return false;
+		}
+		if(policy == DROP_OLDEST){
+			//take the oldest frame back unless the consumer gets to it
+			//first, then the loop finds room either way
+			unsigned long long t = tail.load(std::memory_order_acquire);
+			int oldest = queued[t % depth].load(std::memory_order_relaxed);
+			if(h - t >= (unsigned long long)depth && tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel)){
+				spare = oldest;
+				dropped++;
+			}
+			continue;
+		}
+		
+		//the consumer checks producerWaiting after taking a frame, so
+		//either it sees the flag or the wait sees the frame gone
+		std::unique_lock<std::mutex> lock(waitMutex);
+		producerWaiting = true;
+		while(!closed && h - tail.load() >= (unsigned long long)depth){
+			spaceCondition.wait(lock);
+		}
+		producerWaiting = false;
+	}
+	
+	queued[h % depth].store(writeBuffer, std::memory_order_relaxed);
+	head.store(h + 1, std::memory_order_release);
+	
+	//a dropped frame's buffer is the next one to write, otherwise there
+	//is always a free one, depth + 2 buffers can't all be taken
+	if(spare >= 0){
+		writeBuffer = spare;
+		return true;
+	}
+	while(freeHead.load(std::memory_order_acquire) == freeTail){
+		std::this_thread::yield();
+	}
+	writeBuffer = freeBuffers[freeTail % freeBuffers.size()].load(std::memory_order_relaxed);
+	freeTail++;
+	return true;
+}
+
+const unsigned char* ofxSlitScanIngestQueue::beginPop(){
+	if(depth == 0){
+		return NULL;
+	}
+	endPop();
+	
+	unsigned long long t = tail.load(std::memory_order_acquire);
+	while(t != head.load(std::memory_order_acquire)){
+		//a producer dropping this frame moves tail and the claim fails
+		int index = queued[t % depth].load(std::memory_order_relaxed);
+		if(tail.compare_exchange_weak(t, t + 1)){
+			readBuffer = index;
+			if(producerWaiting){
+				std::lock_guard<std::mutex> lock(waitMutex);
+				spaceCondition.notify_one();
+			}
+			return buffer(index);
+		}
+	}
+	return NULL;
+}
+
+void ofxSlitScanIngestQueue::endPop(){
+	if(readBuffer < 0){
+		return;
+	}
+	unsigned long long f = freeHead.load(std::memory_order_relaxed);
+	freeBuffers[f % freeBuffers.size()].store(readBuffer, std::memory_order_relaxed);
+	freeHead.store(f + 1, std::memory_order_release);
+	readBuffer = -1;
+}
+
+int ofxSlitScanIngestQueue::size(){
+	if(depth == 0){
+		return 0;
+	}
+	unsigned long long t = tail.load();
+	return int(head.load() - t);
+}
+
+unsigned long long ofxSlitScanIngestQueue::takeDropped(){
+	return dropped.exchange(0);
+}
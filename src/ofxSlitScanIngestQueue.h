@@ -0,0 +1,137 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanIngestQueue.h
+ *
+ * A bounded queue of frames between one producer thread, usually a
+ * capture thread, and the thread that owns the history. Neither side
+ * takes a lock. Frames are written into buffers owned by the queue and
+ * the buffers are handed back and forth by index, so a frame is copied
+ * in once and read out once.
+ */
+
+#ifndef _OFX_SLITSCAN_INGEST_QUEUE
+#define _OFX_SLITSCAN_INGEST_QUEUE
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+class ofxSlitScanIngestQueue
+{
+  public:
+	/**
+	 * what a producer does when depth frames are already waiting.
+	 * DROP_OLDEST throws away the oldest waiting frame to make room,
+	 * so the newest frame is never more than depth frames behind.
+	 * DROP_NEWEST throws away the frame being pushed.
+	 * BLOCK waits for the consumer to take a frame
+	 */
+	enum Policy {
+		DROP_OLDEST,
+		DROP_NEWEST,
+		BLOCK
+	};
+	
+	ofxSlitScanIngestQueue();
+	~ofxSlitScanIngestQueue();
+	
+	/**
+	 * drops everything and holds up to depth frames of frameBytes,
+	 * 0 turns the queue off. Not thread safe, no producer may be using
+	 * the queue
+	 */
+	void setup(int depth, size_t frameBytes, Policy policy);
+	bool isSetup();
+	
+	/**
+	 * fails every push from now until the next setup and lets a producer
+	 * blocked in commitPush go. Call before joining the producer thread
+	 */
+	void close();
+	int getDepth();
+	Policy getPolicy();
+	
+	/**
+	 * producer side, from one thread at a time. beginPush returns a
+	 * buffer of frameBytes to write the frame into, commitPush queues
+	 * it. Returns false if the frame was dropped instead
+	 */
+	unsigned char* beginPush();
+	bool commitPush();
+	
+	/**
+	 * consumer side, from one thread at a time. beginPop returns the
+	 * oldest waiting frame, or NULL if there is none. It stays valid
+	 * until endPop, the producer never writes over a frame being read
+	 */
+	const unsigned char* beginPop();
+	void endPop();
+	
+	/**
+	 * frames waiting, only a hint while the producer runs
+	 */
+	int size();
+	
+	/**
+	 * frames dropped since the last call
+	 */
+	unsigned long long takeDropped();
+	
+  protected:
+	unsigned char* buffer(int index);
+	
+	int depth;
+	size_t frameBytes;
+	Policy policy;
+	
+	//depth + 2 buffers, one the producer is writing, up to depth queued,
+	//one the consumer is reading and the rest free. queued holds buffer
+	//indices from tail to head, freeBuffers hands read buffers back to
+	//the producer. Only the producer moves head and freeTail, only the
+	//consumer freeHead, and both pop from tail
+	std::vector<unsigned char> buffers;
+	std::vector<std::atomic<int> > queued;
+	std::vector<std::atomic<int> > freeBuffers;
+	std::atomic<unsigned long long> head;
+	std::atomic<unsigned long long> tail;
+	std::atomic<unsigned long long> freeHead;
+	unsigned long long freeTail;
+	int writeBuffer;
+	int readBuffer;
+	std::atomic<unsigned long long> dropped;
+	
+	//a BLOCK producer sleeps here until the consumer takes a frame
+	std::mutex waitMutex;
+	std::condition_variable spaceCondition;
+	std::atomic<bool> producerWaiting;
+	std::atomic<bool> closed;
+	
+  private:
+	ofxSlitScanIngestQueue(const ofxSlitScanIngestQueue&);
+	ofxSlitScanIngestQueue& operator=(const ofxSlitScanIngestQueue&);
+};
+
+#endif
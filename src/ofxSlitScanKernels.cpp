@@ -0,0 +1,212 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanKernels.cpp
+ */
+
+#include "ofxSlitScanKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define OFX_SLITSCAN_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define OFX_SLITSCAN_TARGET(features)
+	#else
+		#define OFX_SLITSCAN_TARGET(features) __attribute__((target(features)))
+	#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define OFX_SLITSCAN_NEON
+	#include <arm_neon.h>
+#endif
+
+void ofxSlitScanKernels::blendReference(unsigned char* out, const unsigned char* a, const unsigned char* b, const unsigned char* weights, int count){
+	for(int i = 0; i < count; i++){
+		int w = weights[i];
+		out[i] = (a[i] * (256 - w) + b[i] * w + 128) >> 8;
+	}
+}
+
+#ifdef OFX_SLITSCAN_X86
+
+//all of the products fit in 16 bits unsigned: 255*(256-w) + 255*w + 128 = 65408
+
+OFX_SLITSCAN_TARGET("sse4.1")
+static inline __m128i blend8_sse41(__m128i a, __m128i b, __m128i w){
+	__m128i a16 = _mm_cvtepu8_epi16(a);
+	__m128i b16 = _mm_cvtepu8_epi16(b);
+	__m128i w16 = _mm_cvtepu8_epi16(w);
+	__m128i invw16 = _mm_sub_epi16(_mm_set1_epi16(256), w16);
+	__m128i sum = _mm_add_epi16(_mm_mullo_epi16(a16, invw16), _mm_mullo_epi16(b16, w16));
+	sum = _mm_add_epi16(sum, _mm_set1_epi16(128));
+	return _mm_srli_epi16(sum, 8);
+}
+
+OFX_SLITSCAN_TARGET("sse4.1")
+static void blend_sse41(unsigned char* out, const unsigned char* a, const unsigned char* b, const unsigned char* weights, int count){
+	int i = 0;
+	for(; i + 16 <= count; i += 16){
+		__m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+		__m128i vw = _mm_loadu_si128((const __m128i*)(weights + i));
+		__m128i lo = blend8_sse41(va, vb, vw);
+		__m128i hi = blend8_sse41(_mm_srli_si128(va, 8), _mm_srli_si128(vb, 8), _mm_srli_si128(vw, 8));
+		_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(lo, hi));
+	}
+	ofxSlitScanKernels::blendReference(out + i, a + i, b + i, weights + i, count - i);
+}
+
+OFX_SLITSCAN_TARGET("avx2")
+static inline __m256i blend16_avx2(__m128i a, __m128i b, __m128i w){
+	__m256i a16 = _mm256_cvtepu8_epi16(a);
+	__m256i b16 = _mm256_cvtepu8_epi16(b);
+	__m256i w16 = _mm256_cvtepu8_epi16(w);
+	__m256i invw16 = _mm256_sub_epi16(_mm256_set1_epi16(256), w16);
+	__m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(a16, invw16), _mm256_mullo_epi16(b16, w16));
+	sum = _mm256_add_epi16(sum, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(sum, 8);
+}
+
+OFX_SLITSCAN_TARGET("avx2")
+static void blend_avx2(unsigned char* out, const unsigned char* a, const unsigned char* b, const unsigned char* weights, int count){
+	int i = 0;
+	for(; i + 32 <= count; i += 32){
+		__m256i lo = blend16_avx2(_mm_loadu_si128((const __m128i*)(a + i)),
+								  _mm_loadu_si128((const __m128i*)(b + i)),
+								  _mm_loadu_si128((const __m128i*)(weights + i)));
+		__m256i hi = blend16_avx2(_mm_loadu_si128((const __m128i*)(a + i + 16)),
+								  _mm_loadu_si128((const __m128i*)(b + i + 16)),
+								  _mm_loadu_si128((const __m128i*)(weights + i + 16)));
+		//packus works within 128 bit lanes, put the quarters back in order
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+		_mm256_storeu_si256((__m256i*)(out + i), packed);
+	}
+	blend_sse41(out + i, a + i, b + i, weights + i, count - i);
+}
+
+static bool cpuSupportsSSE41(){
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 19)) != 0;
+#else
+	return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+static bool cpuSupportsAVX2(){
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7){
+		return false;
+	}
+	//the OS has to save the ymm registers too
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	if(!osxsave || (_xgetbv(0) & 6) != 6){
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+#ifdef OFX_SLITSCAN_NEON
+
+//a*(255-w) + b*w + a keeps both weights in 8 bits, the rounding shift adds the 128
+static void blend_neon(unsigned char* out, const unsigned char* a, const unsigned char* b, const unsigned char* weights, int count){
+	int i = 0;
+	uint8x16_t all = vdupq_n_u8(255);
+	for(; i + 16 <= count; i += 16){
+		uint8x16_t va = vld1q_u8(a + i);
+		uint8x16_t vb = vld1q_u8(b + i);
+		uint8x16_t vw = vld1q_u8(weights + i);
+		uint8x16_t vinvw = vsubq_u8(all, vw);
+		
+		uint16x8_t lo = vmull_u8(vget_low_u8(va), vget_low_u8(vinvw));
+		lo = vmlal_u8(lo, vget_low_u8(vb), vget_low_u8(vw));
+		lo = vaddw_u8(lo, vget_low_u8(va));
+		
+		uint16x8_t hi = vmull_u8(vget_high_u8(va), vget_high_u8(vinvw));
+		hi = vmlal_u8(hi, vget_high_u8(vb), vget_high_u8(vw));
+		hi = vaddw_u8(hi, vget_high_u8(va));
+		
+		vst1q_u8(out + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+	}
+	ofxSlitScanKernels::blendReference(out + i, a + i, b + i, weights + i, count - i);
+}
+
+#endif
+
+static bool simdEnabled = true;
+
+struct BlendDispatch {
+	ofxSlitScanKernels::BlendFunction function;
+	const char* name;
+};
+
+static BlendDispatch detectBlendFunction(){
+	BlendDispatch dispatch = { ofxSlitScanKernels::blendReference, "reference" };
+#ifdef OFX_SLITSCAN_X86
+	if(cpuSupportsAVX2()){
+		dispatch.function = blend_avx2;
+		dispatch.name = "avx2";
+	}
+	else if(cpuSupportsSSE41()){
+		dispatch.function = blend_sse41;
+		dispatch.name = "sse4.1";
+	}
+#endif
+#ifdef OFX_SLITSCAN_NEON
+	dispatch.function = blend_neon;
+	dispatch.name = "neon";
+#endif
+	return dispatch;
+}
+
+static const BlendDispatch& bestBlend(){
+	static const BlendDispatch dispatch = detectBlendFunction();
+	return dispatch;
+}
+
+ofxSlitScanKernels::BlendFunction ofxSlitScanKernels::getBlendFunction(){
+	return simdEnabled ? bestBlend().function : blendReference;
+}
+
+const char* ofxSlitScanKernels::getBlendFunctionName(){
+	return simdEnabled ? bestBlend().name : "reference";
+}
+
+void ofxSlitScanKernels::setSimdEnabled(bool enabled){
+	simdEnabled = enabled;
+}
+
+bool ofxSlitScanKernels::isSimdEnabled(){
+	return simdEnabled;
+}
@@ -0,0 +1,75 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanKernels.h
+ *
+ * Inner loops for the slit scan render.
+ *
+ * Frame blending uses 8 bit fixed point weights. For every byte
+ *
+ *   out = (a * (256 - w) + b * w + 128) >> 8     w in [0, 255]
+ *
+ * where w is the blend weight toward the newer frame b, rounded
+ * from alpha * 256. blendReference() is the plain C version of that
+ * formula and every SIMD version produces identical bytes, so frames
+ * do not depend on which kernel the CPU ends up running.
+ */
+
+#ifndef _OFX_SLITSCAN_KERNELS
+#define _OFX_SLITSCAN_KERNELS
+
+class ofxSlitScanKernels
+{
+  public:
+	typedef void (*BlendFunction)(unsigned char* out, const unsigned char* a, const unsigned char* b, const unsigned char* weights, int count);
+
+	/**
+	 * blends count bytes of a and b with a weight per byte
+	 */
+	static void blendReference(unsigned char* out, const unsigned char* a, const unsigned char* b, const unsigned char* weights, int count);
+	
+	/**
+	 * returns the fastest blend the running CPU supports,
+	 * picked once by feature detection: AVX2, SSE4.1, NEON or
+	 * the reference
+	 */
+	static BlendFunction getBlendFunction();
+	static const char* getBlendFunctionName();
+	
+	/**
+	 * turn off to force the reference kernel, for comparing output
+	 */
+	static void setSimdEnabled(bool enabled);
+	static bool isSimdEnabled();
+	
+	/**
+	 * converts a blend amount between 0.0 and 1.0 to the fixed point weight
+	 */
+	static inline unsigned char weightForAlpha(float alpha){
+		int weight = int(alpha * 256 + .5f);
+		return weight > 255 ? 255 : (weight < 0 ? 0 : weight);
+	}
+};
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanRing.h
+ *
+ * Resizing the rings of per slot state that make up the history. The
+ * core and the cold store both keep state by slot and resize it the
+ * same way, so a slot means the same frame to both afterwards.
+ */
+
+#ifndef _OFX_SLITSCAN_RING
+#define _OFX_SLITSCAN_RING
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+class ofxSlitScanRing
+{
+  public:
+	/**
+	 * turns ring so slot first comes first, then drops the first -change
+	 * slots or puts change new ones of value in front. slotSize elements
+	 * make up a slot
+	 */
+	template<class T>
+	static void resize(std::vector<T>& ring, int first, int change, const T& value, size_t slotSize = 1){
+		std::rotate(ring.begin(), ring.begin() + first * slotSize, ring.end());
+		if(change < 0){
+			ring.erase(ring.begin(), ring.begin() + -change * slotSize);
+		}
+		else if(change > 0){
+			ring.insert(ring.begin(), change * slotSize, value);
+		}
+	}
+	
+	/**
+	 * where slot of a ring of slots ends up after resize, -1 if it was dropped
+	 */
+	static inline int resizedSlot(int slot, int slots, int first, int change){
+		int turned = (slot - first + slots) % slots;
+		return turned < -change ? -1 : turned + change;
+	}
+};
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanThreadPool.cpp
+ */
+
+#include "ofxSlitScanThreadPool.h"
+
+ofxSlitScanThreadPool::ofxSlitScanThreadPool()
+:currentTask(NULL), taskCount(0), nextTask(0), activeWorkers(0), generation(0), stopping(false) {
+}
+
+ofxSlitScanThreadPool::~ofxSlitScanThreadPool(){
+	stopWorkers();
+}
+
+void ofxSlitScanThreadPool::setNumThreads(int numThreads){
+	if(numThreads <= 0){
+		numThreads = std::thread::hardware_concurrency();
+		if(numThreads <= 0){
+			numThreads = 1;
+		}
+	}
+	
+	if(numThreads == getNumThreads()){
+		return;
+	}
+	
+	std::lock_guard<std::mutex> runLock(runMutex);
+	stopWorkers();
+	for(int i = 1; i < numThreads; i++){
+		workers.push_back(std::thread(&ofxSlitScanThreadPool::workerLoop, this, generation));
+	}
+}
+
+int ofxSlitScanThreadPool::getNumThreads(){
+	return workers.size() + 1;
+}
+
+void ofxSlitScanThreadPool::run(int numTasks, const std::function<void(int)>& task){
+	std::lock_guard<std::mutex> runLock(runMutex);
+	
+	//nothing to share, do it all here
+	if(workers.empty() || numTasks <= 1){
+		for(int i = 0; i < numTasks; i++){
+			task(i);
+		}
+		return;
+	}
+	
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		currentTask = &task;
+		taskCount = numTasks;
+		nextTask = 0;
+		activeWorkers = workers.size();
+		generation++;
+	}
+	wakeCondition.notify_all();
+	
+	runTasks();
+	
+	std::unique_lock<std::mutex> lock(mutex);
+	doneCondition.wait(lock, [this]{ return activeWorkers == 0; });
+	currentTask = NULL;
+}
+
+void ofxSlitScanThreadPool::stopWorkers(){
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeCondition.notify_all();
+	for(size_t i = 0; i < workers.size(); i++){
+		workers[i].join();
+	}
+	workers.clear();
+	stopping = false;
+}
+
+void ofxSlitScanThreadPool::workerLoop(unsigned int seenGeneration){
+	while(true){
+		std::unique_lock<std::mutex> lock(mutex);
+		wakeCondition.wait(lock, [&]{ return stopping || generation != seenGeneration; });
+		if(stopping){
+			return;
+		}
+		seenGeneration = generation;
+		lock.unlock();
+		
+		runTasks();
+		
+		lock.lock();
+		if(--activeWorkers == 0){
+			doneCondition.notify_all();
+		}
+	}
+}
+
+void ofxSlitScanThreadPool::runTasks(){
+	int task;
+	while((task = nextTask++) < taskCount){
+		(*currentTask)(task);
+	}
+}
@@ -0,0 +1,86 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ofxSlitScanThreadPool.h
+ *
+ * A small persistent pool of worker threads used to split the
+ * slit scan render into bands. Tasks are handed out from a shared
+ * counter so faster threads pick up the slack of slower ones.
+ * The calling thread always works on tasks too.
+ */
+
+#ifndef _OFX_SLITSCAN_THREAD_POOL
+#define _OFX_SLITSCAN_THREAD_POOL
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+class ofxSlitScanThreadPool
+{
+  public:
+	ofxSlitScanThreadPool();
+	~ofxSlitScanThreadPool();
+	
+	/**
+	 * total number of threads working on a run, including
+	 * the calling thread. 1 runs everything on the caller,
+	 * 0 uses one thread per hardware core.
+	 */
+	void setNumThreads(int numThreads);
+	int getNumThreads();
+	
+	/**
+	 * calls task(i) for every i in [0, numTasks) spread over
+	 * the pool and returns once they have all finished
+	 */
+	void run(int numTasks, const std::function<void(int)>& task);
+	
+  protected:
+	void stopWorkers();
+	void workerLoop(unsigned int seenGeneration);
+	void runTasks();
+	
+	std::vector<std::thread> workers;
+	std::mutex runMutex;
+	std::mutex mutex;
+	std::condition_variable wakeCondition;
+	std::condition_variable doneCondition;
+	
+	const std::function<void(int)>* currentTask;
+	int taskCount;
+	std::atomic<int> nextTask;
+	int activeWorkers;
+	unsigned int generation;
+	bool stopping;
+	
+  private:
+	ofxSlitScanThreadPool(const ofxSlitScanThreadPool&);
+	ofxSlitScanThreadPool& operator=(const ofxSlitScanThreadPool&);
+};
+
+#endif
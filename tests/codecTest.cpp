@@ -0,0 +1,124 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * codecTest.cpp
+ *
+ * Round trips buffers through ofxSlitScanCodec and feeds it broken
+ * blocks, which have to fail or stay inside dst.
+ */
+
+#include "ofxSlitScanCodec.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+//bytes past the end of dst that decompress must leave alone
+#define GUARD_BYTES 64
+#define GUARD_VALUE 0xA5
+
+static int failures = 0;
+
+static void check(bool condition, const char* message, int size){
+	if(!condition){
+		fprintf(stderr, "codecTest -- %s, %d bytes\n", message, size);
+		failures++;
+	}
+}
+
+//decompresses into size bytes followed by guard bytes, which have to
+//come out untouched whether it works or not
+static bool expand(const std::vector<unsigned char>& block, int size, std::vector<unsigned char>& pixels){
+	pixels.assign(size + GUARD_BYTES, GUARD_VALUE);
+	bool expanded = ofxSlitScanCodec::decompress(block.empty() ? NULL : &block[0], block.size(), size == 0 ? NULL : &pixels[0], size);
+	for(int i = size; i < size + GUARD_BYTES; i++){
+		check(pixels[i] == GUARD_VALUE, "decompress wrote past dst", size);
+	}
+	pixels.resize(size);
+	return expanded;
+}
+
+static void roundTrip(const std::vector<unsigned char>& src){
+	int size = src.size();
+	std::vector<unsigned char> block;
+	ofxSlitScanCodec::compress(src.empty() ? NULL : &src[0], size, block);
+	
+	std::vector<unsigned char> pixels;
+	check(expand(block, size, pixels) && pixels == src, "a block didn't round trip", size);
+	
+	//one byte short of room or one byte too many asked for both fail
+	if(size > 0){
+		check(!expand(block, size - 1, pixels), "a block expanded into too little room", size);
+	}
+	check(!expand(block, size + 1, pixels), "a block expanded to fewer bytes than asked", size);
+	
+	//cutting the block anywhere fails
+	for(size_t length = 0; length < block.size(); length += 1 + block.size() / 97){
+		std::vector<unsigned char> truncated(block.begin(), block.begin() + length);
+		check(!expand(truncated, size, pixels), "a truncated block expanded", size);
+	}
+	
+	//flipped bits can't be told apart from other literals, but the block
+	//either fails or expands to exactly size bytes, never past them
+	for(int flip = 0; flip < 200 && !block.empty(); flip++){
+		std::vector<unsigned char> flipped = block;
+		flipped[rand() % flipped.size()] ^= 1 << (rand() % 8);
+		expand(flipped, size, pixels);
+	}
+}
+
+int main(){
+	srand(1);
+	for(int size = 0; size < 20; size++){
+		std::vector<unsigned char> random(size);
+		for(int i = 0; i < size; i++){
+			random[i] = rand() & 255;
+		}
+		roundTrip(random);
+		roundTrip(std::vector<unsigned char>(size, 7));
+	}
+	
+	std::vector<unsigned char> random(100000);
+	for(size_t i = 0; i < random.size(); i++){
+		random[i] = rand() & 255;
+	}
+	roundTrip(random);
+	
+	//a constant run makes one match far longer than 64K
+	roundTrip(std::vector<unsigned char>(300000, 42));
+	
+	//periodic data matches at short offsets that overlap the copy
+	for(int period = 1; period < 9; period++){
+		std::vector<unsigned char> periodic(70000 + period);
+		for(size_t i = 0; i < periodic.size(); i++){
+			periodic[i] = (i % period) * 37;
+		}
+		roundTrip(periodic);
+	}
+	
+	//a hand made block pointing before the start of the output fails
+	unsigned char badOffset[] = {0x10, 'a', 0x02, 0x00};
+	std::vector<unsigned char> pixels;
+	check(!expand(std::vector<unsigned char>(badOffset, badOffset + 4), 5, pixels), "a match before the output expanded", 5);
+	return failures == 0 ? 0 : 1;
+}
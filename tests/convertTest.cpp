@@ -0,0 +1,189 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * convertTest.cpp
+ *
+ * Checks ofxSlitScanConvert against plain per pixel versions of the
+ * same conversions: same size copies, channel swaps and BT.601 video
+ * range YUV, including odd widths and padded rows.
+ */
+
+#include "ofxSlitScanConvert.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const char* message){
+	if(!condition){
+		fprintf(stderr, "convertTest -- %s\n", message);
+		failures++;
+	}
+}
+
+static std::vector<unsigned char> randomBytes(size_t count){
+	std::vector<unsigned char> bytes(count);
+	for(size_t i = 0; i < count; i++){
+		bytes[i] = rand() & 255;
+	}
+	return bytes;
+}
+
+static std::vector<unsigned char> convert(const std::vector<unsigned char>& src, int w, int h, ofxSlitScanConvert::Format format,
+										  size_t stride, int channels){
+	ofxSlitScanConvert converter;
+	std::vector<unsigned char> dst(w * h * channels);
+	check(converter.setup(w, h, format, w, h, channels, true), "setup failed");
+	converter.convert(&src[0], stride, &dst[0]);
+	return dst;
+}
+
+//BT.601 video range the long way
+static void yuvToRGB(int y, int u, int v, float* rgb){
+	float luma = 1.164f * (y - 16);
+	rgb[0] = luma + 1.596f * (v - 128);
+	rgb[1] = luma - 0.391f * (u - 128) - 0.813f * (v - 128);
+	rgb[2] = luma + 2.018f * (u - 128);
+}
+
+static bool near(const unsigned char* pixel, const float* rgb, int tolerance){
+	for(int i = 0; i < 3; i++){
+		float expected = rgb[i] < 0 ? 0 : (rgb[i] > 255 ? 255 : rgb[i]);
+		if(fabs(pixel[i] - expected) > tolerance){
+			return false;
+		}
+	}
+	return true;
+}
+
+static void testCopy(){
+	int w = 7, h = 5;
+	size_t stride = w * 3 + 5;
+	std::vector<unsigned char> src = randomBytes(stride * h);
+	std::vector<unsigned char> dst = convert(src, w, h, ofxSlitScanConvert::FORMAT_RGB, stride, 3);
+	bool same = true;
+	for(int y = 0; y < h; y++){
+		same = same && std::equal(&src[y * stride], &src[y * stride] + w * 3, &dst[y * w * 3]);
+	}
+	check(same, "a same size RGB frame isn't copied as it is");
+}
+
+static void testSwaps(){
+	int w = 6, h = 4;
+	std::vector<unsigned char> bgr = randomBytes(w * h * 3);
+	std::vector<unsigned char> bgra = randomBytes(w * h * 4);
+	std::vector<unsigned char> fromBGR = convert(bgr, w, h, ofxSlitScanConvert::FORMAT_BGR, 0, 3);
+	std::vector<unsigned char> fromBGRA = convert(bgra, w, h, ofxSlitScanConvert::FORMAT_BGRA, 0, 4);
+	std::vector<unsigned char> fromBGRAToRGB = convert(bgra, w, h, ofxSlitScanConvert::FORMAT_BGRA, 0, 3);
+	bool swapped = true;
+	for(int i = 0; i < w * h; i++){
+		swapped = swapped && fromBGR[i * 3] == bgr[i * 3 + 2] && fromBGR[i * 3 + 1] == bgr[i * 3 + 1] && fromBGR[i * 3 + 2] == bgr[i * 3];
+		swapped = swapped && fromBGRA[i * 4] == bgra[i * 4 + 2] && fromBGRA[i * 4 + 1] == bgra[i * 4 + 1] &&
+			fromBGRA[i * 4 + 2] == bgra[i * 4] && fromBGRA[i * 4 + 3] == bgra[i * 4 + 3];
+		swapped = swapped && fromBGRAToRGB[i * 3] == bgra[i * 4 + 2] && fromBGRAToRGB[i * 3 + 1] == bgra[i * 4 + 1] &&
+			fromBGRAToRGB[i * 3 + 2] == bgra[i * 4];
+	}
+	check(swapped, "BGR or BGRA channels aren't swapped");
+}
+
+static void testKnownYUV(){
+	//black, white and the red of a color bar, two pixels each
+	const unsigned char colors[3][3] = {{16, 128, 128}, {235, 128, 128}, {81, 90, 240}};
+	const unsigned char rgb[3][3] = {{0, 0, 0}, {255, 255, 255}, {255, 0, 0}};
+	for(int i = 0; i < 3; i++){
+		std::vector<unsigned char> yuyv(4);
+		yuyv[0] = yuyv[2] = colors[i][0];
+		yuyv[1] = colors[i][1];
+		yuyv[3] = colors[i][2];
+		std::vector<unsigned char> nv12(6);
+		nv12[0] = nv12[1] = nv12[2] = nv12[3] = colors[i][0];
+		nv12[4] = colors[i][1];
+		nv12[5] = colors[i][2];
+		std::vector<unsigned char> fromYUYV = convert(yuyv, 2, 1, ofxSlitScanConvert::FORMAT_YUYV, 0, 3);
+		std::vector<unsigned char> fromNV12 = convert(nv12, 2, 2, ofxSlitScanConvert::FORMAT_NV12, 0, 3);
+		for(int p = 0; p < 2; p++){
+			check(std::equal(rgb[i], rgb[i] + 3, &fromYUYV[p * 3]), "a YUYV color decodes wrong");
+			check(std::equal(rgb[i], rgb[i] + 3, &fromNV12[p * 3]), "an NV12 color decodes wrong");
+		}
+	}
+}
+
+static void testOddYUV(){
+	//5 pixels wide, the last one has a chroma pair of its own
+	int w = 5, h = 3;
+	size_t stride = 16;
+	std::vector<unsigned char> yuyv = randomBytes(stride * h);
+	std::vector<unsigned char> nv12 = randomBytes(stride * (h + (h + 1) / 2));
+	std::vector<unsigned char> fromYUYV = convert(yuyv, w, h, ofxSlitScanConvert::FORMAT_YUYV, stride, 3);
+	std::vector<unsigned char> fromNV12 = convert(nv12, w, h, ofxSlitScanConvert::FORMAT_NV12, stride, 3);
+	std::vector<unsigned char> grayNV12 = convert(nv12, w, h, ofxSlitScanConvert::FORMAT_NV12, stride, 1);
+	for(int y = 0; y < h; y++){
+		for(int x = 0; x < w; x++){
+			float rgb[3];
+			const unsigned char* pair = &yuyv[y * stride + x / 2 * 4];
+			yuvToRGB(yuyv[y * stride + x * 2], pair[1], pair[3], rgb);
+			check(near(&fromYUYV[(y * w + x) * 3], rgb, 2), "an odd width YUYV frame decodes wrong");
+			
+			const unsigned char* chroma = &nv12[stride * h + y / 2 * stride + x / 2 * 2];
+			yuvToRGB(nv12[y * stride + x], chroma[0], chroma[1], rgb);
+			check(near(&fromNV12[(y * w + x) * 3], rgb, 2), "an odd width NV12 frame decodes wrong");
+			
+			float luma = 1.164f * (nv12[y * stride + x] - 16);
+			luma = luma < 0 ? 0 : (luma > 255 ? 255 : luma);
+			check(fabs(grayNV12[y * w + x] - luma) <= 1, "NV12 to gray isn't the luma");
+		}
+	}
+}
+
+static void testScaled(){
+	//every output pixel of a nearest halving is one of the source pixels
+	int w = 8, h = 6;
+	std::vector<unsigned char> src = randomBytes(w * h * 3);
+	ofxSlitScanConvert converter;
+	std::vector<unsigned char> dst(w / 2 * h / 2 * 3);
+	check(converter.setup(w, h, ofxSlitScanConvert::FORMAT_RGB, w / 2, h / 2, 3, false), "setup failed");
+	converter.convert(&src[0], 0, &dst[0]);
+	bool sampled = true;
+	for(int y = 0; y < h / 2; y++){
+		for(int x = 0; x < w / 2; x++){
+			sampled = sampled && std::equal(&dst[(y * w / 2 + x) * 3], &dst[(y * w / 2 + x) * 3] + 3, &src[((y * 2 + 1) * w + x * 2 + 1) * 3]);
+		}
+	}
+	check(sampled, "a nearest halving doesn't sample pixel centers");
+	check(!converter.setup(0, h, ofxSlitScanConvert::FORMAT_RGB, w, h, 3, false), "an empty frame was accepted");
+	check(!converter.setup(w, h, ofxSlitScanConvert::FORMAT_RGB, w, h, 2, false), "2 channels were accepted");
+}
+
+int main(){
+	srand(1);
+	testCopy();
+	testSwaps();
+	testKnownYUV();
+	testOddYUV();
+	testScaled();
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * equivalenceTest.cpp
+ *
+ * Renders the same noise mapped history with every way the core has of
+ * keeping and rendering it, which all have to match the plain render
+ * byte for byte.
+ */
+
+#include "ofxSlitScanCore.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#define WIDTH 45
+#define HEIGHT 31
+#define CAPACITY 16
+#define FRAMES 40
+
+enum Mode {
+	PLAIN,
+	BUCKETED,
+	SPARSE,
+	FILE_BACKED,
+	ASYNC,
+	REGIONS
+};
+
+static const char* modeNames[] = {"plain", "bucketed", "sparse", "file backed", "async", "region"};
+
+static int failures = 0;
+
+static void check(bool condition, const char* message, Mode mode, bool blend){
+	if(!condition){
+		fprintf(stderr, "equivalenceTest -- %s, %s render%s\n", message, modeNames[mode], blend ? " with blending" : "");
+		failures++;
+	}
+}
+
+static std::vector<unsigned char> noise(size_t size){
+	std::vector<unsigned char> pixels(size);
+	for(size_t i = 0; i < size; i++){
+		pixels[i] = rand() & 255;
+	}
+	return pixels;
+}
+
+//renders the output in four uneven regions, rows a full output apart
+static void renderRegions(ofxSlitScanCore& core, unsigned char* pixels, Mode mode, bool blend){
+	size_t stride = WIDTH * 3;
+	int left = WIDTH / 3;
+	int top = HEIGHT / 2 + 1;
+	check(core.renderRegion(0, 0, left, top, pixels, stride) &&
+		  core.renderRegion(left, 0, WIDTH - left, top, pixels + left * 3, stride) &&
+		  core.renderRegion(0, top, left, HEIGHT - top, pixels + top * stride, stride) &&
+		  core.renderRegion(left, top, WIDTH - left, HEIGHT - top, pixels + top * stride + left * 3, stride),
+		  "a region was turned down", mode, blend);
+}
+
+//every output of a run, one after each frame
+static std::vector<unsigned char> run(Mode mode, bool blend, const std::vector<unsigned char>& map,
+									  const std::vector<std::vector<unsigned char> >& frames){
+	ofxSlitScanCore core;
+	core.setup(WIDTH, HEIGHT, CAPACITY, 3);
+	core.setDelayMap(&map[0], 1);
+	core.setTimeDelayAndWidth(2, CAPACITY - 4);
+	core.setBlending(blend);
+	
+	if(mode == BUCKETED){
+		core.setBucketedRendering(true);
+		core.setNumThreads(3);
+	}
+	else if(mode == SPARSE){
+		core.setSparseRetention(true);
+	}
+	else if(mode == FILE_BACKED){
+		check(core.setHistoryDirectory("."), "the history file couldn't be made", mode, blend);
+	}
+	else if(mode == ASYNC){
+		core.setAsyncRendering(true, false);
+	}
+	
+	size_t outputBytes = WIDTH * HEIGHT * 3;
+	std::vector<unsigned char> outputs(outputBytes * frames.size());
+	for(size_t i = 0; i < frames.size(); i++){
+		core.addFrame(&frames[i][0]);
+		if(mode == REGIONS){
+			renderRegions(core, &outputs[outputBytes * i], mode, blend);
+		}
+		else{
+			core.copyOutput(&outputs[outputBytes * i]);
+		}
+	}
+	return outputs;
+}
+
+int main(){
+	srand(1);
+	std::vector<unsigned char> map = noise(WIDTH * HEIGHT);
+	std::vector<std::vector<unsigned char> > frames;
+	for(int i = 0; i < FRAMES; i++){
+		frames.push_back(noise(WIDTH * HEIGHT * 3));
+	}
+	
+	std::vector<unsigned char> plain[2];
+	for(int blend = 0; blend < 2; blend++){
+		plain[blend] = run(PLAIN, blend, map, frames);
+		for(int mode = BUCKETED; mode <= REGIONS; mode++){
+			check(run(Mode(mode), blend, map, frames) == plain[blend], "the output doesn't match the plain render", Mode(mode), blend);
+		}
+	}
+	
+	//otherwise every mode could be matching an empty render
+	check(plain[0] != plain[1], "blending didn't change the output", PLAIN, true);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ingestQueueTest.cpp
+ *
+ * Queues frames into a core whose ingest queue was set before setup,
+ * then again after setup moves to a larger frame size.
+ */
+
+#include "ofxSlitScanCore.h"
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const char* message){
+	if(!condition){
+		fprintf(stderr, "ingestQueueTest -- %s\n", message);
+		failures++;
+	}
+}
+
+static void queueFrames(ofxSlitScanCore& core, int w, int h, int count){
+	std::vector<unsigned char> frame(w * h * 3);
+	for(int i = 0; i < count; i++){
+		frame.assign(frame.size(), (unsigned char)(i + 1));
+		check(core.queueFrame(&frame[0]), "a queued frame was dropped");
+		core.takeQueuedFrames();
+	}
+	
+	//the newest frame went in whole
+	std::vector<unsigned char> newest(w * h * 3);
+	core.pixelsForFrame(core.getCapacity() - 1, &newest[0]);
+	check(newest == frame, "the newest frame doesn't match what was queued");
+}
+
+int main(){
+	ofxSlitScanCore core;
+	core.setIngestQueue(4, ofxSlitScanIngestQueue::BLOCK);
+	core.setup(64, 48, 10, 3);
+	queueFrames(core, 64, 48, 10);
+	
+	core.setup(128, 96, 10, 3);
+	queueFrames(core, 128, 96, 10);
+	
+	check(core.getStats().framesAdded == 10, "setup didn't start the count over");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/**
+ * 
+ * The MIT License
+ * 
+ * Copyright (c) 2010, 2011 James George http://www.jamesgeorge.org
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * ringTest.cpp
+ *
+ * Fills a small history, shrinks and grows it, and checks every frame
+ * is still where pixelsForFrame and getThumbnail say it is.
+ */
+
+#include "ofxSlitScanCore.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#define WIDTH 64
+#define HEIGHT 48
+
+enum Mode {
+	PLAIN,
+	COLD,
+	SPARSE,
+	THUMBNAILS
+};
+
+static const char* modeNames[] = {"plain", "cold", "sparse", "thumbnails"};
+
+static int failures = 0;
+
+static void check(bool condition, const char* message, Mode mode){
+	if(!condition){
+		fprintf(stderr, "ringTest -- %s, %s history\n", message, modeNames[mode]);
+		failures++;
+	}
+}
+
+//every frame is different but compresses well
+static std::vector<unsigned char> frameFor(int frameId){
+	std::vector<unsigned char> frame(WIDTH * HEIGHT * 3);
+	for(size_t i = 0; i < frame.size(); i++){
+		frame[i] = (unsigned char)(i % (WIDTH * 3) + frameId * 16);
+	}
+	return frame;
+}
+
+//frameIds oldest first, 0 for a frame that was never written
+static void checkOrder(ofxSlitScanCore& core, const std::vector<int>& frameIds, Mode mode){
+	check(core.getCapacity() == (int)frameIds.size(), "the capacity is wrong", mode);
+	std::vector<unsigned char> pixels(WIDTH * HEIGHT * 3);
+	for(int num = 0; num < core.getCapacity(); num++){
+		core.pixelsForFrame(num, &pixels[0]);
+		if(frameIds[num] == 0){
+			check(pixels == std::vector<unsigned char>(pixels.size(), 0), "an empty frame isn't black", mode);
+		}
+		else{
+			check(pixels == frameFor(frameIds[num]), "a frame is out of order", mode);
+		}
+	}
+}
+
+//thumbnails of the frames still kept, keyed by frameId
+static void checkThumbnails(ofxSlitScanCore& core, const std::vector<int>& frameIds,
+							const std::vector<std::vector<unsigned char> >& thumbnails, Mode mode){
+	size_t bytes = core.getThumbnailWidth() * core.getThumbnailHeight() * 3;
+	for(int num = 0; num < core.getCapacity(); num++){
+		const unsigned char* thumbnail = core.getThumbnail(num);
+		check(thumbnail != NULL, "a thumbnail is missing", mode);
+		if(thumbnail != NULL && frameIds[num] != 0){
+			check(std::vector<unsigned char>(thumbnail, thumbnail + bytes) == thumbnails[frameIds[num]], "a thumbnail is out of order", mode);
+		}
+	}
+}
+
+//the compressor runs on its own thread, give it a moment to catch up
+static void waitForCold(ofxSlitScanCore& core){
+	for(int i = 0; i < 500 && core.getHistoryBytes() >= 4 * WIDTH * HEIGHT * 3; i++){
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	check(core.getHistoryBytes() < 4 * WIDTH * HEIGHT * 3, "old frames weren't compressed", COLD);
+}
+
+static void resize(ofxSlitScanCore& core, int capacity, Mode mode){
+	core.setCapacity(capacity);
+	core.setTimeDelayAndWidth(0, capacity);
+	if(mode == COLD){
+		waitForCold(core);
+	}
+}
+
+static void testMode(Mode mode){
+	ofxSlitScanCore core;
+	core.setup(WIDTH, HEIGHT, 10, 3);
+	core.setTimeDelayAndWidth(0, 10);
+	
+	//every pixel reads the oldest frame, so sparse retention keeps it all
+	std::vector<unsigned char> map(WIDTH * HEIGHT, 0);
+	core.setDelayMap(&map[0], 1);
+	
+	if(mode == COLD){
+		core.setColdCompression(2);
+	}
+	else if(mode == SPARSE){
+		core.setSparseRetention(true);
+	}
+	else if(mode == THUMBNAILS){
+		core.setThumbnails(8, 6);
+	}
+	
+	std::vector<std::vector<unsigned char> > thumbnails(13);
+	for(int frameId = 1; frameId <= 10; frameId++){
+		core.addFrame(&frameFor(frameId)[0]);
+		if(mode == THUMBNAILS){
+			thumbnails[frameId].assign(core.getThumbnail(9), core.getThumbnail(9) + 8 * 6 * 3);
+		}
+	}
+	if(mode == COLD){
+		waitForCold(core);
+	}
+	int full[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+	checkOrder(core, std::vector<int>(full, full + 10), mode);
+	
+	//shrinking lets the oldest go
+	resize(core, 6, mode);
+	int shrunk[] = {5, 6, 7, 8, 9, 10};
+	checkOrder(core, std::vector<int>(shrunk, shrunk + 6), mode);
+	
+	//growing adds empty frames older than the oldest
+	resize(core, 9, mode);
+	int grown[] = {0, 0, 0, 5, 6, 7, 8, 9, 10};
+	checkOrder(core, std::vector<int>(grown, grown + 9), mode);
+	if(mode == THUMBNAILS){
+		checkThumbnails(core, std::vector<int>(grown, grown + 9), thumbnails, mode);
+	}
+	
+	//new frames go in after the newest
+	for(int frameId = 11; frameId <= 12; frameId++){
+		core.addFrame(&frameFor(frameId)[0]);
+		if(mode == THUMBNAILS){
+			thumbnails[frameId].assign(core.getThumbnail(8), core.getThumbnail(8) + 8 * 6 * 3);
+		}
+	}
+	int added[] = {0, 5, 6, 7, 8, 9, 10, 11, 12};
+	checkOrder(core, std::vector<int>(added, added + 9), mode);
+	if(mode == THUMBNAILS){
+		checkThumbnails(core, std::vector<int>(added, added + 9), thumbnails, mode);
+	}
+}
+
+int main(){
+	testMode(PLAIN);
+	testMode(COLD);
+	testMode(SPARSE);
+	testMode(THUMBNAILS);
+	return failures == 0 ? 0 : 1;
+}